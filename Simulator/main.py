@@ -41,11 +41,14 @@ def parseArguments():
     parser = argparse.ArgumentParser(description="CC25 simulator v3")
     parser.add_argument("map", help="Path to the map file, must be in Map directory")
     parser.add_argument("--players", "-p", nargs='+', help="A list of players name, must be in Players directory")
+    parser.add_argument("--seed", type=int, default=None, help="Seed for the starting positions and power-ups, to replay a game (e.g. one played by Source/arena)")
     parserArgs = parser.parse_args()
-    return parserArgs.map, parserArgs.players
+    return parserArgs.map, parserArgs.players, parserArgs.seed
 
 def main():
-    map_file_path, names_of_teams = parseArguments()
+    map_file_path, names_of_teams, seed = parseArguments()
+    if seed is not None:
+        random.seed(seed)
     logger = JSONlogger()
     board, frequency = readGameBeforeStarting(map_file_path)
     listOfPlayers = ListOfPlayers(len(names_of_teams)) 
@@ -0,0 +1,67 @@
+import argparse
+import random
+
+from board import *
+
+# Writes random boards with what Board.updateCoveredArea makes of them, for
+# the enclosure check in Source/parity. Per board:
+#   BOARD <M> <N> <colours>
+#   <M rows before>
+#   <M rows after updateCoveredArea(colours)>
+# Half the boards are noise, the other half rectangles of one colour drawn
+# over noise, which is how enclosures come about in a game.
+
+CELLS = ".#AaBbCcDd"
+
+def randomCell(rng : random.Random, colors : int) -> str:
+    while True:
+        cell = rng.choice(CELLS)
+        if not cell.isalpha() or ord(cell.upper()) - ord('A') < colors:
+            return cell
+
+def randomBoard(rng : random.Random, M : int, N : int, colors : int) -> Board:
+    board = Board()
+    board.setNumberOfRows(M)
+    board.setNumberOfColumns(N)
+    density = rng.random()
+    main = chr(ord('A') + rng.randrange(colors))
+    for x in range(M):
+        board.setRow(x, "".join(randomCell(rng, colors) if rng.random() < density else rng.choice(main + main + ".")
+                                for y in range(N)))
+    if rng.random() < 0.5:
+        for _ in range(rng.randint(1, 4)):
+            color = chr(ord('A') + rng.randrange(colors))
+            top, left = rng.randrange(M), rng.randrange(N)
+            bottom, right = rng.randint(top, M - 1), rng.randint(left, N - 1)
+            for x in range(top, bottom + 1):
+                for y in range(left, right + 1):
+                    if x in (top, bottom) or y in (left, right):
+                        board.setCell(x, y, color.lower() if rng.random() < 0.1 else color)
+    return board
+
+def parseArguments():
+    parser = argparse.ArgumentParser(description = "Writes random boards and their updateCoveredArea result for Source/parity")
+    parser.add_argument("output", help = "Board file to write")
+    parser.add_argument("--boards", type = int, default = 200, help = "How many boards (default 200)")
+    parser.add_argument("--max-size", type = int, default = 24, help = "Largest side of most boards (default 24)")
+    parser.add_argument("--seed", type = int, default = 1, help = "Seed of the boards (default 1)")
+    return parser.parse_args()
+
+def main():
+    args = parseArguments()
+    rng = random.Random(args.seed)
+    with open(args.output, "w") as outputFile:
+        for i in range(args.boards):
+            # Every tenth board goes up to the largest map the bots accept
+            largest = 60 if i % 10 == 9 else args.max_size
+            M, N = rng.randint(1, largest), rng.randint(1, largest)
+            colors = rng.randint(1, 4)
+            board = randomBoard(rng, M, N, colors)
+            before = list(board.grid)
+            board.updateCoveredArea(colors)
+            outputFile.write(f"BOARD {M} {N} {colors}\n")
+            outputFile.write("\n".join(before + board.grid) + "\n")
+    print(f"{args.boards} boards written to {args.output}")
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,105 @@
+import argparse
+import glob
+import json
+import os
+import re
+
+# Packs recorded turns into one corpus file for the bots' -DBOT_BENCH builds
+# (see Source/common/bench.h). Two sources are read from the Match folder:
+#   Match/Players/<bot>/turnN/  MAP.INP as the bot got it, with the STATE.DAT
+#                               it left after turn N - 1
+#   Match/<game>.json           every player's view of every turn, written the
+#                               way FileInteractor writes MAP.INP
+
+def formatMapInput(event : dict, index : int) -> str:
+    players = event["players"]
+    grid = event["map"]["grid"]
+    M = event["map"]["rows"]
+    N = event["map"]["columns"]
+    order = sorted(players.keys(), key = int)
+
+    def positionOf(key):
+        player = players[key]
+        if not player["alive"]:
+            return -1, -1
+        return player["position"]["x"], player["position"]["y"]
+
+    lines = [f"{M} {N} {event['frequency']} {event['turn']}"]
+    X, Y = positionOf(order[index])
+    lines.append(f"{X} {Y} {players[order[index]]['color']}")
+    lines.append(f"{len(order) - 1}")
+    for j in range(len(order)):
+        if j == index:
+            continue
+        X, Y = positionOf(order[j])
+        lines.append(f"{X} {Y} {players[order[j]]['color']}")
+    for row in grid:
+        # JSONlogger marks cells sealed by the shrink with '*'; MAP.INP has '#'
+        lines.append(" ".join(row.replace("*", "#")))
+    lines.append(f"{len(event['powerups'])}")
+    for powerUp in event["powerups"]:
+        lines.append(f"{powerUp['x']} {powerUp['y']} {powerUp['type']}")
+    return "\n".join(lines) + "\n"
+
+def stateOf(player : dict) -> str:
+    # STATE.DAT is saved after the bot's own decrement, one behind the
+    # simulator's counter
+    boost = max(player["tangtoc"] - 1, 0) if player["powerup"] == "tangtoc" else 0
+    oil = max(player["dautron"] - 1, 0) if player["powerup"] == "dautron" else 0
+    return f"{boost} {oil} {1 if oil > 0 else 0}"
+
+def snapshotsFromJSON(path : str):
+    with open(path, "r") as inputFile:
+        events = json.load(inputFile)
+    game = os.path.splitext(os.path.basename(path))[0]
+    for turn in sorted(events.keys(), key = int):
+        event = dict(events[turn])
+        event["turn"] = int(turn)
+        for index, key in enumerate(sorted(event["players"].keys(), key = int)):
+            yield f"{game}:{index}:turn{turn}", formatMapInput(event, index), stateOf(event["players"][key])
+
+def readState(path : str):
+    if not os.path.exists(path):
+        return None
+    with open(path, "r") as inputFile:
+        values = inputFile.read().split()
+    values = (values + ["0", "0", "0"])[:3] # OnlyUp / OnlyDown keep only the boost
+    return " ".join(values)
+
+def snapshotsFromTurnFolders(path : str):
+    for botFolder in sorted(glob.glob(os.path.join(path, "Players", "*"))):
+        bot = os.path.basename(botFolder)
+        turns = []
+        for turnFolder in glob.glob(os.path.join(botFolder, "turn*")):
+            match = re.fullmatch(r"turn(\d+)", os.path.basename(turnFolder))
+            if match and os.path.exists(os.path.join(turnFolder, "MAP.INP")):
+                turns.append(int(match.group(1)))
+        for turn in sorted(turns):
+            with open(os.path.join(botFolder, f"turn{turn}", "MAP.INP"), "r") as inputFile:
+                mapInput = inputFile.read()
+            state = readState(os.path.join(botFolder, f"turn{turn - 1}", "STATE.DAT")) if turn > 0 else None
+            yield f"{bot}:turn{turn}", mapInput, state
+
+def parseArguments():
+    parser = argparse.ArgumentParser(description = "Packs recorded turns into a benchmark corpus")
+    parser.add_argument("output", help = "Corpus file to write")
+    parser.add_argument("--match", default = "./Match", help = "Match folder to read (default ./Match)")
+    return parser.parse_args()
+
+def main():
+    args = parseArguments()
+    count = 0
+    with open(args.output, "w") as outputFile:
+        sources = [snapshotsFromTurnFolders(args.match)]
+        sources += [snapshotsFromJSON(path) for path in sorted(glob.glob(os.path.join(args.match, "*.json")))]
+        for source in sources:
+            for label, mapInput, state in source:
+                outputFile.write(f"SNAPSHOT {label}\n")
+                outputFile.write(mapInput if mapInput.endswith("\n") else mapInput + "\n")
+                if state is not None:
+                    outputFile.write(f"STATE {state}\n")
+                count += 1
+    print(f"{count} snapshots written to {args.output}")
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,60 @@
+import argparse
+import glob
+import json
+import os
+
+# Packs games logged in the Match folder into the replay file Source/parity
+# reads, so the native forward model can be checked against this simulator.
+# Per game:
+#   GAME <name> <M> <N> <K> <players> <turns>
+# then per logged turn:
+#   TURN <turn>
+#   <x> <y> <alive> <tangtoc> <dautron> <powerup>   one line per player
+#   <M rows of the grid>
+#   <number of power-ups>
+#   <x> <y> <type> <timeout>                        one line per power-up
+# <powerup> is none, tangtoc or dautron. A dead player keeps its last position.
+
+def formatTurn(turn : int, event : dict) -> str:
+    players = event["players"]
+    lines = [f"TURN {turn}"]
+    for key in sorted(players.keys(), key = int):
+        player = players[key]
+        powerUp = player["powerup"] if player["powerup"] is not None else "none"
+        lines.append(f"{player['position']['x']} {player['position']['y']} {int(player['alive'])} "
+                     f"{player['tangtoc']} {player['dautron']} {powerUp}")
+    for row in event["map"]["grid"]:
+        # JSONlogger marks cells sealed by the shrink with '*'; the board has '#'
+        lines.append(row.replace("*", "#"))
+    lines.append(f"{len(event['powerups'])}")
+    for powerUp in event["powerups"]:
+        lines.append(f"{powerUp['x']} {powerUp['y']} {powerUp['type']} {powerUp['timeout']}")
+    return "\n".join(lines) + "\n"
+
+def formatGame(path : str) -> str:
+    with open(path, "r") as inputFile:
+        events = json.load(inputFile)
+    game = os.path.splitext(os.path.basename(path))[0]
+    turns = sorted(events.keys(), key = int)
+    first = events[turns[0]]
+    header = (f"GAME {game} {first['map']['rows']} {first['map']['columns']} {first['frequency']} "
+              f"{len(first['players'])} {len(turns)}\n")
+    return header + "".join(formatTurn(int(turn), events[turn]) for turn in turns)
+
+def parseArguments():
+    parser = argparse.ArgumentParser(description = "Packs logged games into a replay file for Source/parity")
+    parser.add_argument("output", help = "Replay file to write")
+    parser.add_argument("games", nargs = "*", help = ".json logs to pack (default every one in --match)")
+    parser.add_argument("--match", default = "./Match", help = "Match folder to read (default ./Match)")
+    return parser.parse_args()
+
+def main():
+    args = parseArguments()
+    paths = args.games if args.games else sorted(glob.glob(os.path.join(args.match, "*.json")))
+    with open(args.output, "w") as outputFile:
+        for path in paths:
+            outputFile.write(formatGame(path))
+    print(f"{len(paths)} games written to {args.output}")
+
+if __name__ == "__main__":
+    main()
@@ -9,12 +9,16 @@
 #include <random> // For random choice if needed for tie-breaking
 #include <limits> // For std::numeric_limits
 
-// --- Constants ---
-const char EMPTY_CELL = '.';
-const char OBSTACLE_CELL = '#';
-const char SPEED_BOOST_ITEM = 'G';
-const char PAINT_BOMB_ITEM = 'E';
-const char OIL_SLICK_ITEM = 'F';
+#include "../common/flat_grid.h" // Cell constants and the padded flat board
+#include "../common/bitboard.h"  // Colour/obstacle/item bit-planes over the same indices
+#include "../common/map_parser.h" // Single-read MAP.INP decoder shared by all bots
+#include "../common/bot_api.h"    // C entry points for in-process hosts
+#include "../common/eval_weights.h" // Named evaluate_move constants
+#include "../common/opening_book.h" // Turn-0 starting cell per map
+#include "opening_book_data.h"        // This bot's book, written by Source/opening_book
+#if defined(BOT_BENCH)
+#include "../common/bench.h" // Corpus replay, latency and allocation counting
+#endif
 
 // --- Helper Structs/Classes ---
 
@@ -51,8 +55,10 @@ struct ItemOnMap
 class GameState;
 struct MoveOption;
 
-double evaluate_move(GameState &gs, int next_x, int next_y, int current_x, int current_y, bool used_oil_slick_for_this_move);
-MoveOption decide_move(GameState &gs);
+template <typename Policy>
+double evaluate_move(GameState &gs, const Policy &w, int next_x, int next_y, int current_x, int current_y, bool used_oil_slick_for_this_move);
+template <typename Policy>
+MoveOption decide_move(GameState &gs, const Policy &w);
 std::pair<int, int> choose_initial_position(GameState &gs);
 
 class GameState
@@ -61,8 +67,10 @@ public:
     int M, N, K_shrink_period, current_turn;
     Player my_player;
     std::vector<Player> other_players;
-    std::vector<std::vector<char>> grid;
+    FlatGrid grid;
     std::vector<ItemOnMap> items_on_map; // Parsed from input
+    BoardPlanes planes;                  // Bitboard view of grid + items_on_map
+    BitPlane opponent_cells;             // Cells occupied by live opponents
 
     // My active items state
     int speed_boost_turns_left;
@@ -74,54 +82,42 @@ public:
                   speed_boost_turns_left(0), paint_bomb_just_picked_up(false),
                   oil_slick_turns_to_expire(0), has_oil_slick(false) {}
 
-    void parse_input(const std::string &filename = "MAP.INP")
+    // Parses one turn in MAP.INP format without touching the item state
+    bool parse_input_text(const char *begin, const char *end)
     {
-        std::ifstream ifs(filename);
-        if (!ifs.is_open())
+        MapInput input;
+        std::string error;
+        if (!parse_map_text(begin, end, input, grid, &error))
         {
-            std::cerr << "Error: Could not open " << filename << std::endl;
-            // In a real contest, might need to exit or throw
-            return;
-        }
-
-        ifs >> M >> N >> K_shrink_period >> current_turn;
-
-        int my_x, my_y;
-        char my_color_char;
-        ifs >> my_x >> my_y >> my_color_char;
-        my_player = Player(my_x, my_y, my_color_char);
-
-        int num_other_players;
-        ifs >> num_other_players;
-        other_players.clear(); // Clear before resizing/populating
-        for (int i = 0; i < num_other_players; ++i)
-        {
-            int p_x, p_y;
-            char p_color;
-            ifs >> p_x >> p_y >> p_color;
-            other_players.emplace_back(p_x, p_y, p_color);
+            std::cerr << "Error: Could not parse turn input: " << error << std::endl;
+            grid.reset(0, 0);
+            return false;
         }
+        apply_map_input(input);
+        return true;
+    }
 
-        grid.assign(M, std::vector<char>(N)); // Resize and initialize
-        for (int i = 0; i < M; ++i)
+    // Copies everything but the grid (parse_map_text writes that in place)
+    void apply_map_input(const MapInput &input)
+    {
+        M = input.M;
+        N = input.N;
+        K_shrink_period = input.K;
+        current_turn = input.turn;
+        my_player = Player(input.me.x, input.me.y, input.me.color);
+
+        other_players.clear(); // Clear before populating
+        for (const MapPlayer &op : input.others)
         {
-            for (int j = 0; j < N; ++j)
-            {
-                ifs >> grid[i][j];
-            }
+            other_players.emplace_back(op.x, op.y, op.color);
         }
 
-        int num_map_items;
-        ifs >> num_map_items;
         items_on_map.clear(); // Clear before populating
-        for (int i = 0; i < num_map_items; ++i)
+        for (const MapItem &map_item : input.items)
         {
-            ItemOnMap item;
-            ifs >> item.r >> item.c >> item.type;
-            items_on_map.push_back(item);
+            items_on_map.push_back({map_item.r, map_item.c, map_item.type});
         }
-        ifs.close();
-        load_my_item_state(); // Load persistent state after parsing current turn's map
+        build_planes();
     }
 
     void save_my_item_state(const std::string &filename = "STATE.DAT")
@@ -144,10 +140,7 @@ public:
         if (!ifs.is_open())
         {
             // File not found (e.g., first turn) or unreadable
-            speed_boost_turns_left = 0;
-            oil_slick_turns_to_expire = 0;
-            has_oil_slick = false;
-            paint_bomb_just_picked_up = false; // Ensure reset
+            reset_my_item_state();
             return;
         }
         int has_oil_slick_int = 0; // Default to 0 if read fails
@@ -166,6 +159,38 @@ public:
         ifs.close();
     }
 
+    void reset_my_item_state()
+    {
+        speed_boost_turns_left = 0;
+        oil_slick_turns_to_expire = 0;
+        has_oil_slick = false;
+        paint_bomb_just_picked_up = false;
+    }
+
+    void build_planes()
+    {
+        planes.build(grid);
+        for (const auto &item : items_on_map)
+        {
+            if (is_within_bounds(item.r, item.c))
+                planes.items.set(grid.idx(item.r, item.c));
+        }
+        opponent_cells.clear_all();
+        for (const auto &op : other_players)
+        {
+            if (!op.eliminated && is_within_bounds(op.x, op.y))
+                opponent_cells.set(grid.idx(op.x, op.y));
+        }
+    }
+
+    // Plane of my own colour, or an empty plane if my colour is unknown
+    const BitPlane &my_color_cells() const
+    {
+        static const BitPlane no_cells;
+        int k = color_index(my_player.color_char);
+        return k >= 0 ? planes.color[k] : no_cells;
+    }
+
     bool is_within_bounds(int r, int c) const
     {
         return r >= 0 && r < M && c >= 0 && c < N;
@@ -187,23 +212,22 @@ public:
         return false;
     }
 
+    // (r, c) may lie up to GRID_PAD cells outside the board; the sentinel frame rejects it.
     bool is_valid_for_move(int r, int c, bool can_pass_one_obstacle = false) const
     {
-        if (!is_within_bounds(r, c))
-        {
-            return false;
-        }
-
-        char cell_content = grid[r][c];
-        bool is_obstacle_type = (cell_content == OBSTACLE_CELL || (cell_content >= 'a' && cell_content <= 'd'));
+        return is_valid_for_move_idx(grid.idx(r, c), can_pass_one_obstacle);
+    }
 
-        if (is_obstacle_type)
+    bool is_valid_for_move_idx(int idx, bool can_pass_one_obstacle = false) const
+    {
+        if (planes.blocked.test(idx))
         {
-            return can_pass_one_obstacle; // Allow if oil slick is active for this specific step
+            // Allow if oil slick is active for this specific step, but never off the board
+            return can_pass_one_obstacle && grid[idx] != BORDER_CELL;
         }
 
         // Crucial: Check if landing on this cell means elimination due to shrinking THIS turn
-        if (cell_will_be_sealed_this_turn(r, c))
+        if (cell_will_be_sealed_this_turn(grid.row_of(idx), grid.col_of(idx)))
         {
             return false;
         }
@@ -236,7 +260,7 @@ public:
             // std::cerr << "DEBUG: Picked up " << picked_up_item_char << " at (" << next_x << "," << next_y << ")" << std::endl;
             if (picked_up_item_char == SPEED_BOOST_ITEM)
             {
-                speed_boost_turns_left = 5; // "tự động kích hoạt ... hiệu lực sau 5 lượt"
+                speed_boost_turns_left = StandardRules::BOOST_TURNS; // "tự động kích hoạt ... hiệu lực sau 5 lượt"
             }
             else if (picked_up_item_char == PAINT_BOMB_ITEM)
             {
@@ -246,7 +270,7 @@ public:
             else if (picked_up_item_char == OIL_SLICK_ITEM)
             {
                 has_oil_slick = true;
-                oil_slick_turns_to_expire = 5; // "nếu sau 5 lượt ... không kích hoạt thì ... biến mất"
+                oil_slick_turns_to_expire = StandardRules::OIL_TURNS; // "nếu sau 5 lượt ... không kích hoạt thì ... biến mất"
             }
         }
     }
@@ -289,52 +313,70 @@ public:
 
 std::pair<int, int> choose_initial_position(GameState &gs)
 {
-    // Generate random valid starting position
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<int> dist_x(0, gs.M - 1);
-    std::uniform_int_distribution<int> dist_y(0, gs.N - 1);
-    
-    // Try to find a valid random position
-    int max_attempts = 100; // Avoid infinite loop
-    for (int attempt = 0; attempt < max_attempts; ++attempt) {
-        int rand_x = dist_x(gen);
-        int rand_y = dist_y(gen);
-        
-        // Check if this position is valid
-        if (gs.grid[rand_x][rand_y] == EMPTY_CELL && 
-            gs.is_valid_for_move(rand_x, rand_y, false)) {
-            return {rand_x, rand_y};
-        }
-    }
-    
-    // Fallback: If no valid random position found after attempts, 
-    // search systematically for any valid position
-    for (int r = 0; r < gs.M; ++r) {
-        for (int c = 0; c < gs.N; ++c) {
-            if (gs.grid[r][c] == EMPTY_CELL && 
-                gs.is_valid_for_move(r, c, false)) {
-                return {r, c};
-            }
-        }
-    }
-    
+    // The opening book's cell for this map, or the best by rank_start_cells
+    // on a map it does not know
+    int start = opening_start(OPENING_BOOK, gs.grid, gs.K_shrink_period);
+    if (start >= 0)
+        return {gs.grid.row_of(start), gs.grid.col_of(start)};
+
     // Last resort: return center position
     return {gs.M / 2, gs.N / 2};
 }
 
-double evaluate_move(GameState &gs, int next_x, int next_y, int current_x, int current_y, bool used_oil_slick_for_this_move)
+// --- Evaluation Weights ---
+//
+// Everything evaluate_move adds or subtracts, in the order of WEIGHTS below.
+// Source/tuner --write rewrites the numbers in this table. DefaultWeights
+// compiles them into evaluate_move (see eval_weights.h).
+
+enum GreedyWeight
+{
+    W_BOMB_PICKUP,    // Picking up a paint bomb
+    W_SPEED_PICKUP,   // Picking up a speed boost
+    W_OIL_PICKUP,     // Picking up an oil slick
+    W_BOMB_CELL,      // Per empty or enemy cell a picked-up bomb paints
+    W_EMPTY_CELL,     // Landing on an empty cell
+    W_ENEMY_CELL,     // Landing on an enemy cell
+    W_OWN_CELL,       // Landing on my own colour
+    W_STAY_PENALTY,   // Standing still
+    W_SHRINK_PENALTY, // Per turn inside the last period before the cell is sealed
+    W_CENTER_PENALTY, // Per step from the centre
+    W_STEAL_CELL,     // Landing on an opponent standing on its own colour
+    W_NEAR_OPPONENT,  // Per step closer than 3 to an opponent
+    W_OIL_USE,        // Using the oil slick
+    NUM_WEIGHTS
+};
+
+constexpr EvalParam WEIGHTS[NUM_WEIGHTS] = {
+    {"bomb_pickup", 1211.0},
+    {"speed_pickup", 191.5},
+    {"oil_pickup", 268.9},
+    {"bomb_cell", 30.72},
+    {"empty_cell", 76.11},
+    {"enemy_cell", 333.5},
+    {"own_cell", 9.08},
+    {"stay_penalty", 1.293},
+    {"shrink_penalty", 4.637},
+    {"center_penalty", 0.6901},
+    {"steal_cell", 109.3},
+    {"near_opponent", 3.402},
+    {"oil_use", 44.91},
+};
+
+typedef FixedWeights<WEIGHTS> DefaultWeights;
+
+template <typename Policy>
+double evaluate_move(GameState &gs, const Policy &w, int next_x, int next_y, int current_x, int current_y, bool used_oil_slick_for_this_move)
 {
     double score = 0.0;
     char my_color = gs.my_player.color_char;
 
     // Basic validity: landing on obstacle/sealed or out of bounds is infinitely bad.
     // This should ideally be filtered by `decide_move` before calling `evaluate_move`.
-    if (!gs.is_within_bounds(next_x, next_y))
-        return -std::numeric_limits<double>::infinity();
-
-    char target_cell_on_grid_char = gs.grid[next_x][next_y];
-    if (target_cell_on_grid_char == OBSTACLE_CELL || (target_cell_on_grid_char >= 'a' && target_cell_on_grid_char <= 'd'))
+    // Off-board targets read the sentinel frame, which counts as blocked.
+    int target_idx = gs.grid.idx(next_x, next_y);
+    char target_cell_on_grid_char = gs.grid[target_idx];
+    if (gs.planes.blocked.test(target_idx))
     {
         // Cannot land on an obstacle or sealed cell, even if oil slick was used for the path
         return -std::numeric_limits<double>::infinity();
@@ -349,7 +391,7 @@ double evaluate_move(GameState &gs, int next_x, int next_y, int current_x, int c
     bool can_pickup_new_item = !(gs.speed_boost_turns_left > 0 || gs.has_oil_slick);
     char item_at_target_type = 0; // 0 indicates no item or no pickuppable item
 
-    if (can_pickup_new_item)
+    if (can_pickup_new_item && gs.planes.items.test(target_idx))
     {
         for (const auto &item_on_map : gs.items_on_map)
         {
@@ -364,90 +406,52 @@ double evaluate_move(GameState &gs, int next_x, int next_y, int current_x, int c
     if (item_at_target_type != 0)
     {
         if (item_at_target_type == PAINT_BOMB_ITEM)
-            score += 1000.0;
+            score += w[W_BOMB_PICKUP];
         else if (item_at_target_type == SPEED_BOOST_ITEM)
-            score += 800.0;
+            score += w[W_SPEED_PICKUP];
         else if (item_at_target_type == OIL_SLICK_ITEM)
-            score += 700.0;
+            score += w[W_OIL_PICKUP];
 
         // If Paint Bomb *is picked up by this specific move*:
         if (item_at_target_type == PAINT_BOMB_ITEM)
         {
-            int bomb_gain = 0;
-            for (int dr_bomb = -2; dr_bomb <= 2; ++dr_bomb)
-            { // 5x5 area
-                for (int dc_bomb = -2; dc_bomb <= 2; ++dc_bomb)
-                {
-                    int bomb_r = next_x + dr_bomb;
-                    int bomb_c = next_y + dc_bomb;
-                    if (gs.is_within_bounds(bomb_r, bomb_c))
-                    {
-                        char cell_char_in_bomb_area = gs.grid[bomb_r][bomb_c];
-                        bool cell_is_paintable_by_bomb = true;
-
-                        if (cell_char_in_bomb_area == OBSTACLE_CELL || (cell_char_in_bomb_area >= 'a' && cell_char_in_bomb_area <= 'd'))
-                        {
-                            cell_is_paintable_by_bomb = false;
-                        }
-
-                        // Rule: "Nếu trong vùng có người chơi khác, các ô đó không bị tô"
-                        // Rule: "Nếu một ô có nhiều hơn một người chơi thì màu của ô đó giữ nguyên"
-                        // Interpretation: if any *other* player is on the cell, or if multiple players (even if one is me) are on the cell.
-                        int players_on_bombed_cell = 0;
-                        bool other_player_on_bombed_cell = false;
-
-                        if (!gs.my_player.eliminated && gs.my_player.x == bomb_r && gs.my_player.y == bomb_c)
-                        {
-                            players_on_bombed_cell++;
-                        }
-                        for (const auto &op : gs.other_players)
-                        {
-                            if (!op.eliminated && op.x == bomb_r && op.y == bomb_c)
-                            {
-                                players_on_bombed_cell++;
-                                other_player_on_bombed_cell = true;
-                            }
-                        }
-
-                        if (other_player_on_bombed_cell || players_on_bombed_cell > 1)
-                        {
-                            cell_is_paintable_by_bomb = false;
-                        }
-
-                        if (cell_is_paintable_by_bomb && cell_char_in_bomb_area != my_color)
-                        { // Counts empty and enemy cells
-                            bomb_gain++;
-                        }
-                    }
-                }
+            // Rule: "Nếu trong vùng có người chơi khác, các ô đó không bị tô"
+            // Rule: "Nếu một ô có nhiều hơn một người chơi thì màu của ô đó giữ nguyên"
+            // Interpretation: any cell with another player on it (alone or together with me) keeps its colour.
+            // Counts empty and enemy cells in the bomb's square. The sentinel frame is
+            // part of the blocked plane, so the window needs no bounds check.
+            if (w[W_BOMB_CELL] != 0.0)
+            {
+                int bomb_gain = gs.planes.count_window_free(gs.grid, target_idx, Policy::BOMB_RADIUS,
+                                                            gs.planes.blocked, gs.my_color_cells(), gs.opponent_cells);
+                score += bomb_gain * w[W_BOMB_CELL]; // Each cell from bomb is valuable
             }
-            score += bomb_gain * 20.0; // Each cell from bomb is valuable
         }
     }
 
     // 2. Coloring Tiles (based on what's on grid *before* this move)
     if (target_cell_on_grid_char == EMPTY_CELL)
     {
-        score += 100.0;
+        score += w[W_EMPTY_CELL];
     }
     else if (isupper(target_cell_on_grid_char) && target_cell_on_grid_char != my_color)
     { // Enemy color
-        score += 150.0;
+        score += w[W_ENEMY_CELL];
     }
     else if (target_cell_on_grid_char == my_color)
     {                  // My color
-        score += 10.0; // Moving to an already owned cell (less good, but ok for repositioning)
+        score += w[W_OWN_CELL]; // Moving to an already owned cell (less good, but ok for repositioning)
     }
 
     if (next_x == current_x && next_y == current_y)
     {                 // Staying put
-        score -= 1.0; // Slight penalty for not actively expanding, unless it's a strategic hold.
+        score -= w[W_STAY_PENALTY]; // Slight penalty for not actively expanding, unless it's a strategic hold.
     }
 
     // 3. Positional Advantages / Disadvantages
     //    - Avoid edges that will shrink soon
     int s_level_next = std::min({next_x, gs.M - 1 - next_x, next_y, gs.N - 1 - next_y});
-    if (gs.K_shrink_period > 0)
+    if (gs.K_shrink_period > 0 && w[W_SHRINK_PENALTY] != 0.0)
     { // Avoid division by zero if K is somehow 0
         int turn_of_shrink_for_target_layer = (s_level_next + 1) * gs.K_shrink_period;
         int turns_until_shrink = turn_of_shrink_for_target_layer - gs.current_turn; // turns from START of this turn
@@ -460,38 +464,41 @@ double evaluate_move(GameState &gs, int next_x, int next_y, int current_x, int c
         }
         else if (turns_until_shrink <= gs.K_shrink_period)
         {
-            score -= (gs.K_shrink_period - turns_until_shrink + 1) * 8.0; // Penalty gets worse closer to shrink
+            score -= (gs.K_shrink_period - turns_until_shrink + 1) * w[W_SHRINK_PENALTY]; // Penalty gets worse closer to shrink
         }
     }
 
     // Prefer cells closer to map center
     int dist_to_center_r = std::abs(next_x - gs.M / 2);
     int dist_to_center_c = std::abs(next_y - gs.N / 2);
-    score -= (dist_to_center_r + dist_to_center_c) * 1.0; // Small penalty for being far from center
+    score -= (dist_to_center_r + dist_to_center_c) * w[W_CENTER_PENALTY]; // Small penalty for being far from center
 
     // 4. Aggression/Defense (simple version)
-    for (const auto &op : gs.other_players)
+    if (w[W_STEAL_CELL] != 0.0 || w[W_NEAR_OPPONENT] != 0.0)
     {
-        if (!op.eliminated)
+        for (const auto &op : gs.other_players)
         {
-            int dist_to_op = std::abs(next_x - op.x) + std::abs(next_y - op.y);
-            if (dist_to_op == 0)
-            { // Moving onto an opponent's current tile
-                if (target_cell_on_grid_char == op.color_char)
-                {                  // Stealing their colored tile
-                    score += 75.0; // Significant bonus for direct capture of territory
+            if (!op.eliminated)
+            {
+                int dist_to_op = std::abs(next_x - op.x) + std::abs(next_y - op.y);
+                if (dist_to_op == 0)
+                { // Moving onto an opponent's current tile
+                    if (target_cell_on_grid_char == op.color_char)
+                    {                  // Stealing their colored tile
+                        score += w[W_STEAL_CELL]; // Significant bonus for direct capture of territory
+                    }
+                }
+                else if (dist_to_op < 3)
+                {                                    // If moving near an opponent
+                    score += (3 - dist_to_op) * w[W_NEAR_OPPONENT]; // Small bonus for being near opponents (potential future captures)
                 }
-            }
-            else if (dist_to_op < 3)
-            {                                    // If moving near an opponent
-                score += (3 - dist_to_op) * 5.0; // Small bonus for being near opponents (potential future captures)
             }
         }
     }
 
     if (used_oil_slick_for_this_move)
     {
-        score += 50.0; // Bonus for using a limited resource effectively
+        score += w[W_OIL_USE]; // Bonus for using a limited resource effectively
     }
 
     return score;
@@ -508,7 +515,8 @@ struct MoveOption
         : x(_x), y(_y), oil_used(_oil), steps(_s), score(_scr) {}
 };
 
-MoveOption decide_move(GameState &gs)
+template <typename Policy>
+MoveOption decide_move(GameState &gs, const Policy &w)
 {
     int my_current_x = gs.my_player.x;
     int my_current_y = gs.my_player.y;
@@ -558,12 +566,8 @@ MoveOption decide_move(GameState &gs)
                 // Case A: Intermediate cell (inter_r, inter_c) IS the obstacle, final_r,c is clear
                 // Here, is_valid_for_move(inter_r, inter_c, true) means we check if it's an obstacle we can pass
                 // And final_r, final_c must be clear without oil.
-                bool inter_is_passable_obstacle = false;
-                if (gs.is_within_bounds(inter_r, inter_c))
-                {
-                    char inter_cell_char = gs.grid[inter_r][inter_c];
-                    inter_is_passable_obstacle = (inter_cell_char == OBSTACLE_CELL || (inter_cell_char >= 'a' && inter_cell_char <= 'd'));
-                }
+                char inter_cell_char = gs.grid.at(inter_r, inter_c);
+                bool inter_is_passable_obstacle = (inter_cell_char != BORDER_CELL && is_blocked_cell(inter_cell_char));
 
                 if (inter_is_passable_obstacle && gs.is_valid_for_move(final_r, final_c, false))
                 {
@@ -582,13 +586,10 @@ MoveOption decide_move(GameState &gs)
     std::vector<MoveOption> valid_landings_options;
     for (const auto &opt : candidate_options)
     {
-        if (!gs.is_within_bounds(opt.x, opt.y))
-            continue;
-
-        char landing_cell_char = gs.grid[opt.x][opt.y];
-        if (landing_cell_char == OBSTACLE_CELL || (landing_cell_char >= 'a' && landing_cell_char <= 'd'))
+        char landing_cell_char = gs.grid.at(opt.x, opt.y);
+        if (is_blocked_cell(landing_cell_char))
         {
-            continue; // Cannot land on an obstacle or sealed cell
+            continue; // Cannot land on an obstacle, sealed cell or off the board
         }
         if (gs.cell_will_be_sealed_this_turn(opt.x, opt.y))
         {
@@ -608,7 +609,7 @@ MoveOption decide_move(GameState &gs)
     // Evaluate all valid candidate options
     for (auto &opt : valid_landings_options)
     { // Use reference to modify score in place
-        opt.score = evaluate_move(gs, opt.x, opt.y, my_current_x, my_current_y, opt.oil_used);
+        opt.score = evaluate_move(gs, w, opt.x, opt.y, my_current_x, my_current_y, opt.oil_used);
     }
 
     // Sort to find the best move: higher score first.
@@ -632,7 +633,7 @@ MoveOption decide_move(GameState &gs)
     if (valid_landings_options.empty() || valid_landings_options[0].score <= -std::numeric_limits<double>::infinity() + 1.0)
     { // check against actual -INF
         // Evaluate staying put if it wasn't considered or had a bad score before
-        double stay_score = evaluate_move(gs, my_current_x, my_current_y, my_current_x, my_current_y, false);
+        double stay_score = evaluate_move(gs, w, my_current_x, my_current_y, my_current_x, my_current_y, false);
         // Check if current spot is actually valid to stay on
         if (gs.is_valid_for_move(my_current_x, my_current_y, false))
         {
@@ -647,16 +648,27 @@ MoveOption decide_move(GameState &gs)
     return valid_landings_options[0]; // The best option after sorting
 }
 
-// --- Main Execution ---
-int main()
+// The compiled-in evaluator, or the run-time one once --weights was given
+MoveOption decide_move(GameState &gs, const EvalWeights &weights)
 {
-    // Optional: For faster I/O in competitive programming, though less critical for file I/O
-    std::ios_base::sync_with_stdio(false);
-    std::cin.tie(NULL); // If reading from cin, not used here
+    if (weights.is_overridden())
+        return decide_move(gs, RuntimeWeights<>(weights));
+    return decide_move(gs, DefaultWeights());
+}
 
-    GameState gs;
-    gs.parse_input("MAP.INP"); // Reads from MAP.INP and loads STATE.DAT
+double evaluate_move(GameState &gs, const EvalWeights &weights, int next_x, int next_y, int current_x, int current_y, bool used_oil_slick_for_this_move)
+{
+    if (weights.is_overridden())
+        return evaluate_move(gs, RuntimeWeights<>(weights), next_x, next_y, current_x, current_y, used_oil_slick_for_this_move);
+    return evaluate_move(gs, DefaultWeights(), next_x, next_y, current_x, current_y, used_oil_slick_for_this_move);
+}
 
+// --- Turn Execution ---
+
+// Decides the move for an already parsed turn and advances my item state to
+// what it will be at the start of the next turn
+std::pair<int, int> play_turn(GameState &gs, const EvalWeights &weights)
+{
     int final_next_x = -1, final_next_y = -1;
     bool decided_to_use_oil_this_turn = false;
 
@@ -674,7 +686,7 @@ int main()
     }
     else
     {
-        MoveOption best_move = decide_move(gs);
+        MoveOption best_move = decide_move(gs, weights);
         final_next_x = best_move.x;
         final_next_y = best_move.y;
         decided_to_use_oil_this_turn = best_move.oil_used;
@@ -699,20 +711,6 @@ int main()
     // 2. Decrement active item durations. Pass whether oil was *activated* for the chosen move.
     gs.decrement_item_durations(decided_to_use_oil_this_turn);
 
-    // 3. Save persistent item state for the *next* turn
-    gs.save_my_item_state();
-
-    std::ofstream move_out_file("MOVE.OUT");
-    if (move_out_file.is_open())
-    {
-        move_out_file << final_next_x << " " << final_next_y << std::endl;
-        move_out_file.close();
-    }
-    else
-    {
-        std::cerr << "Error: Could not open MOVE.OUT for writing." << std::endl;
-    }
-
     // Optional: Debugging output to stderr (remove or comment out for submission)
     /*
     std::cerr << "Turn: " << gs.current_turn << std::endl;
@@ -727,5 +725,207 @@ int main()
     std::cerr << "PaintBombJustPickedUpFlag (after pickup check): " << (gs.paint_bomb_just_picked_up ? "YES" : "NO") << std::endl;
     */
 
+    return {final_next_x, final_next_y};
+}
+
+// --- Plugin ABI ---
+//
+// See bot_api.h. main() below is a wrapper that loads STATE.DAT into an
+// instance, calls bot_decide on MAP.INP and saves STATE.DAT again.
+
+struct BotInstance
+{
+    EvalWeights weights;
+    std::string weights_text; // bot_weights()
+    GameState gs;
+    int last_turn; // -1 before the first turn of a game
+
+    BotInstance() : weights(WEIGHTS), last_turn(-1) {}
+
+    // Back to a fresh instance, keeping the weights
+    void reset()
+    {
+        gs = GameState();
+        last_turn = -1;
+    }
+};
+
+// Applies one main.exe argument (only --weights=), warning about anything else
+void apply_option(BotInstance &bot, const std::string &arg)
+{
+    std::string error;
+    if (arg.compare(0, 10, "--weights=") != 0)
+        std::cerr << "Warning: ignoring unknown option " << arg << std::endl;
+    else if (!bot.weights.parse(arg.substr(10), &error))
+        std::cerr << "Warning: ignoring " << arg << ": " << error << std::endl;
+}
+
+int bot_api_version(void)
+{
+    return BOT_API_VERSION;
+}
+
+BotInstance *bot_create(const char *options)
+{
+    BotInstance *bot = new BotInstance();
+    std::istringstream args(options ? options : "");
+    std::string arg;
+    while (args >> arg)
+        apply_option(*bot, arg);
+    return bot;
+}
+
+int bot_init(BotInstance *bot, const char *map_text, size_t length)
+{
+    bot->reset();
+    return bot->gs.parse_input_text(map_text, map_text + length) ? 0 : -1;
+}
+
+int bot_decide(BotInstance *bot, const char *map_text, size_t length, int *x, int *y)
+{
+    GameState &gs = bot->gs;
+    if (!gs.parse_input_text(map_text, map_text + length))
+    {
+        *x = gs.my_player.x;
+        *y = gs.my_player.y;
+        return -1;
+    }
+    if (gs.current_turn <= bot->last_turn)
+        gs.reset_my_item_state(); // A new game
+    gs.paint_bomb_just_picked_up = false;
+    bot->last_turn = gs.current_turn;
+
+    std::pair<int, int> move = play_turn(gs, bot->weights);
+    *x = move.first;
+    *y = move.second;
     return 0;
-}
\ No newline at end of file
+}
+
+void bot_reset(BotInstance *bot)
+{
+    bot->reset();
+}
+
+void bot_destroy(BotInstance *bot)
+{
+    delete bot;
+}
+
+const char *bot_weights(BotInstance *bot)
+{
+    bot->weights_text = bot->weights.format();
+    return bot->weights_text.c_str();
+}
+
+#if defined(BOT_BENCH)
+
+// --- Benchmark Mode ---
+//
+// Built with -DBOT_BENCH, main.exe times parse_input, evaluate_move on every
+// one-step landing and decide_move over a corpus from
+// Simulator/pack_corpus.py: `main.exe corpus.txt [--passes=N]`. Each snapshot
+// gets a fresh GameState, as every turn does under the simulator. --weights=
+// times the run-time evaluator instead of the compiled-in one.
+int main(int argc, char *argv[])
+{
+    std::string corpus_file;
+    int passes = 1;
+    EvalWeights weights(WEIGHTS);
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        std::string error;
+        if (arg.compare(0, 9, "--passes=") == 0)
+            passes = std::max(1, std::atoi(arg.c_str() + 9));
+        else if (arg.compare(0, 10, "--weights=") == 0)
+        {
+            if (!weights.parse(arg.substr(10), &error))
+                std::cerr << "Warning: ignoring " << arg << ": " << error << std::endl;
+        }
+        else if (arg.compare(0, 2, "--") != 0 && corpus_file.empty())
+            corpus_file = arg;
+        else
+            std::cerr << "Warning: ignoring unknown argument " << arg << std::endl;
+    }
+    std::vector<BenchSnapshot> corpus;
+    std::string error;
+    if (corpus_file.empty() || !load_bench_corpus(corpus_file, corpus, &error))
+    {
+        std::cerr << (corpus_file.empty() ? "usage: " + std::string(argv[0]) + " corpus.txt [--passes=N] [--weights=...]" : "bench: " + error) << std::endl;
+        return 1;
+    }
+
+    BenchStats parse_stats("parse_input"), evaluate_stats("evaluate_move"), decide_stats("decide_move");
+    int decided = 0;
+    for (int pass = 0; pass < passes; ++pass)
+    {
+        for (const BenchSnapshot &snapshot : corpus)
+        {
+            GameState gs;
+            bool parsed = false;
+            parse_stats.time([&]
+                             { parsed = gs.parse_input_text(snapshot.map.data(), snapshot.map.data() + snapshot.map.size()); });
+            if (!parsed || gs.current_turn == 0 || gs.my_player.eliminated)
+                continue;
+            gs.speed_boost_turns_left = snapshot.speed_boost_turns_left;
+            gs.oil_slick_turns_to_expire = snapshot.oil_slick_turns_to_expire;
+            gs.has_oil_slick = snapshot.has_oil_slick == 1;
+            ++decided;
+
+            for (const auto &dir : DIRECTIONS)
+            {
+                int next_r = gs.my_player.x + dir.dr;
+                int next_c = gs.my_player.y + dir.dc;
+                if (gs.is_valid_for_move(next_r, next_c, false))
+                    evaluate_stats.time([&] { evaluate_move(gs, weights, next_r, next_c, gs.my_player.x, gs.my_player.y, false); });
+            }
+            decide_stats.time([&] { decide_move(gs, weights); });
+        }
+    }
+
+    std::cout << corpus.size() << " snapshots, " << decided / passes << " to decide, " << passes << " pass(es)\n";
+    BenchStats::print_header(std::cout);
+    parse_stats.print(std::cout);
+    evaluate_stats.print(std::cout);
+    decide_stats.print(std::cout);
+    return 0;
+}
+
+#elif !defined(BOT_LIBRARY)
+
+// --- Main Execution ---
+int main(int argc, char *argv[])
+{
+    // Optional: For faster I/O in competitive programming, though less critical for file I/O
+    std::ios_base::sync_with_stdio(false);
+    std::cin.tie(NULL); // If reading from cin, not used here
+
+    BotInstance bot;
+    for (int i = 1; i < argc; ++i)
+        apply_option(bot, argv[i]);
+    std::string map_text;
+    if (!read_whole_file("MAP.INP", map_text))
+        std::cerr << "Error: Could not open MAP.INP" << std::endl;
+    bot.gs.load_my_item_state(); // Parsing leaves the item state alone, so it can come first
+
+    int final_next_x = -1, final_next_y = -1;
+    bot_decide(&bot, map_text.data(), map_text.size(), &final_next_x, &final_next_y);
+
+    // Save persistent item state for the *next* turn
+    bot.gs.save_my_item_state();
+
+    std::ofstream move_out_file("MOVE.OUT");
+    if (move_out_file.is_open())
+    {
+        move_out_file << final_next_x << " " << final_next_y << std::endl;
+        move_out_file.close();
+    }
+    else
+    {
+        std::cerr << "Error: Could not open MOVE.OUT for writing." << std::endl;
+    }
+
+    return 0;
+}
+
+#endif
\ No newline at end of file
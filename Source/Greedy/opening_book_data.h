@@ -0,0 +1,15 @@
+#pragma once
+
+// Written by Source/opening_book; rebuild the bots after changing it.
+// Per map: opening_map_hash of its turn-0 board, the map file, and its best
+// starting cells (row, col), best first.
+const OpeningBookEntry OPENING_BOOK[] = {
+    {0x6e5112c2e5fb2a28ull, "A.txt", {{13, 16}, {16, 14}, {8, 12}, {16, 17}}},
+    {0x3ca7993022b01661ull, "B.txt", {{4, 17}, {11, 14}, {14, 7}, {1, 4}}},
+    {0x68dc00c27262fc04ull, "C.txt", {{4, 17}, {7, 1}, {14, 14}, {14, 1}}},
+    {0x745668795e435251ull, "D.txt", {{16, 2}, {5, 2}, {2, 17}, {19, 8}}},
+    {0xeb5110de27264a77ull, "E.txt", {{1, 14}, {14, 15}, {1, 8}, {7, 8}}},
+    {0x4891dbbf694c973bull, "F.txt", {{4, 4}, {9, 10}, {6, 10}, {13, 19}}},
+    {0x1b5d1ca99a5555dbull, "G.txt", {{4, 12}, {16, 13}, {1, 12}, {18, 1}}},
+    {0x917fa5c334d1453dull, "H.txt", {{1, 4}, {8, 1}, {1, 8}, {1, 1}}},
+};
@@ -1,53 +1,59 @@
 #include <bits/stdc++.h>
 
+#include "../common/flat_grid.h"
+#include "../common/map_parser.h"
+#include "../common/bot_api.h"
+#include "../common/opening_book.h"
+
 using namespace std;
 
 int M, N, K, T, currentX, currentY, P;
-vector<vector<char> > board;
+FlatGrid board; // Padded with BORDER_CELL, so off-board probes need no bounds check
 char color;
 int tangtocTurns = 0; // Added for Tangtoc power-up
 int powerups_num;
 map<pair<int,int>, char> powerups;
 
-void input() {
-
-    int X, Y;
-    char C;
-
-    ifstream inputFile("MAP.INP");
+// Fills the globals from one turn in MAP.INP format; false if it does not parse
+bool parseTurn(const char *begin, const char *end) {
 
-    inputFile >> M >> N >> K >> T >> currentX >> currentY >> color >> P;
+    MapInput mapInput;
+    string error;
+    bool parsed = parse_map_text(begin, end, mapInput, board, &error);
 
-    for (int i = 0; i < P; ++i)
-        inputFile >> X >> Y >> C;
-
-    board.resize(M, vector<char>(N, '.'));
-
-    for (int x = 0, y; x < M; ++x)
-        for (y = 0; y < N; ++y)
-            inputFile >> board[x][y];
-    
-    inputFile >> powerups_num;
-    for (int i = 0; i < powerups_num; ++i) {
-        int x, y;
-        char c;
-        inputFile >> x >> y >> c;
-        powerups[{x, y}] = c; // Add power-ups to the map
+    if (!parsed) {
+        cerr << "Error: Could not parse MAP.INP: " << error << endl;
+        mapInput = MapInput(); // Fall back to "not placed yet"
+        board.reset(0, 0);
     }
 
-    inputFile.close();
-
-    ifstream stateFile("STATE.DAT");
-    if (stateFile.is_open()) {
-        stateFile >> tangtocTurns;
-        stateFile.close();
-    } else {
-        tangtocTurns = 0; // Default if file doesn't exist or cannot be opened
-    }
+    M = mapInput.M;
+    N = mapInput.N;
+    K = mapInput.K;
+    T = mapInput.turn;
+    currentX = mapInput.me.x;
+    currentY = mapInput.me.y;
+    color = mapInput.me.color;
+    P = mapInput.others.size();
+
+    powerups_num = mapInput.items.size();
+    powerups.clear();
+    for (const MapItem &item : mapInput.items)
+        powerups[{item.r, item.c}] = item.type; // Add power-ups to the map
+
+    return parsed;
 }
 
 pair<int, int> solve() {
     if (currentX == -1 && currentY == -1) { // Initial placement
+        if (board.is_within_bounds(9, 9) && board.at(9, 9) == EMPTY_CELL) {
+            return {9, 9};
+        }
+        // Blocked on this map: the best start by rank_start_cells rather than main.py's random one
+        vector<int> ranked = rank_start_cells(board);
+        if (!ranked.empty()) {
+            return {board.row_of(ranked[0]), board.col_of(ranked[0])};
+        }
         return {9, 9};
     }
 
@@ -71,16 +77,16 @@ pair<int, int> solve() {
             int x2_final = currentX + 2 * dx;
             int y2_final = currentY + 2 * dy;
 
+            char intermediate = board.at(x1_intermediate, y1_intermediate);
+            char final_cell = board.at(x2_final, y2_final);
+
             // Check intermediate step: in bounds and not an obstacle
-            if (x1_intermediate >= 0 && x1_intermediate < M && 
-                y1_intermediate >= 0 && y1_intermediate < N && 
-                board[x1_intermediate][y1_intermediate] != '#') {
+            if (intermediate != BORDER_CELL && intermediate != '#') {
                 
                 // Check final 2-step destination: in bounds, not an obstacle, and not own color
-                if (x2_final >= 0 && x2_final < M && 
-                    y2_final >= 0 && y2_final < N && 
-                    board[x2_final][y2_final] != '#' && 
-                    board[x2_final][y2_final] != color) {
+                if (final_cell != BORDER_CELL && 
+                    final_cell != '#' && 
+                    final_cell != color) {
                     
                     next_move_candidate = make_pair(x2_final, y2_final);
                     move_made = true;
@@ -96,11 +102,12 @@ pair<int, int> solve() {
             int nextX = currentX + dx;
             int nextY = currentY + dy;
 
+            char next_cell = board.at(nextX, nextY);
+
             // Check 1-step destination: in bounds, not an obstacle, and not own color
-            if (nextX >= 0 && nextX < M && 
-                nextY >= 0 && nextY < N && 
-                board[nextX][nextY] != '#' && 
-                board[nextX][nextY] != color) {
+            if (next_cell != BORDER_CELL && 
+                next_cell != '#' && 
+                next_cell != color) {
                 
                 next_move_candidate = make_pair(nextX, nextY);
                 move_made = true;
@@ -120,6 +127,58 @@ pair<int, int> solve() {
     return next_move_candidate;
 }
 
+// --- Plugin ABI ---
+// See bot_api.h. The bot lives in the globals above, so an instance only
+// carries the boost counter from one turn to the next, and calls on
+// different instances must not overlap either.
+
+struct BotInstance {
+    int tangtocTurns = 0;
+    int lastTurn = -1; // -1 before the first turn of a game
+};
+
+int bot_api_version(void) {
+    return BOT_API_VERSION;
+}
+
+BotInstance *bot_create(const char *options) {
+    istringstream args(options ? options : "");
+    string arg;
+    while (args >> arg)
+        cerr << "Warning: ignoring unknown option " << arg << endl;
+    return new BotInstance();
+}
+
+int bot_init(BotInstance *bot, const char *map_text, size_t length) {
+    *bot = BotInstance();
+    return parseTurn(map_text, map_text + length) ? 0 : -1;
+}
+
+int bot_decide(BotInstance *bot, const char *map_text, size_t length, int *x, int *y) {
+    bool parsed = parseTurn(map_text, map_text + length);
+    if (T <= bot->lastTurn)
+        bot->tangtocTurns = 0; // A new game
+    bot->lastTurn = T;
+
+    tangtocTurns = bot->tangtocTurns;
+    pair<int, int> nextPositions = solve();
+    bot->tangtocTurns = tangtocTurns;
+
+    *x = nextPositions.first;
+    *y = nextPositions.second;
+    return parsed ? 0 : -1;
+}
+
+void bot_reset(BotInstance *bot) {
+    *bot = BotInstance();
+}
+
+void bot_destroy(BotInstance *bot) {
+    delete bot;
+}
+
+#if !defined(BOT_LIBRARY)
+
 void output(const pair<int, int> &nextPositions) {
     ofstream outputFile("MOVE.OUT");
     outputFile << nextPositions.first << ' ' << nextPositions.second << '\n';
@@ -139,8 +198,24 @@ int main() {
     cin.tie(0) -> sync_with_stdio(0);
     cout.tie(0);
 
-    input();
-    output(solve());
+    BotInstance bot;
+    ifstream stateFile("STATE.DAT");
+    if (stateFile.is_open()) {
+        stateFile >> bot.tangtocTurns;
+        stateFile.close();
+    } else {
+        bot.tangtocTurns = 0; // Default if file doesn't exist or cannot be opened
+    }
+
+    string mapText;
+    if (!read_whole_file("MAP.INP", mapText))
+        cerr << "Error: Could not open MAP.INP" << endl;
+
+    pair<int, int> nextPositions;
+    bot_decide(&bot, mapText.data(), mapText.size(), &nextPositions.first, &nextPositions.second);
+    output(nextPositions);
 
     return 0;
 }
+
+#endif
@@ -0,0 +1,224 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../common/match.h"
+#include "../common/thread_pool.h"
+
+// --- Arena ---
+//
+// Plays games of the simulator's rules natively, many at a time:
+//   arena [options] PLAYER PLAYER [PLAYER [PLAYER]]
+// Every game seats the players in the order given (the first is 'A'). See
+// parse_player_spec for PLAYER, e.g. "lib:./libbot.so --engine=alphabeta"
+// or exe:Simulator/Players/Greedy/main.exe. Game g on a map uses seed
+// --seed + g, which replays as `python main.py <map> -p ... --seed <n>`.
+
+struct ArenaOptions
+{
+    std::vector<std::string> maps;
+    std::string map_dir = "Simulator/Map";
+    int games = 1; // Per map
+    uint64_t seed = 1;
+    int jobs = 0; // Games at once; 0 is one per hardware thread
+    int timeout_ms = 2000;
+    std::string temp_dir;
+    bool keep_dirs = false;
+};
+
+struct ArenaGame
+{
+    int map;
+    uint64_t seed;
+};
+
+// Per player, over every game it played
+struct ArenaTally
+{
+    int games = 0, wins = 0, draws = 0, losses = 0;
+    long long area = 0, death_turn = 0;
+};
+
+std::string map_path(const ArenaOptions &options, const std::string &name)
+{
+    if (name.find('/') != std::string::npos)
+        return name;
+    std::string file = name.find('.') == std::string::npos ? name + ".txt" : name;
+    return options.map_dir + "/" + file;
+}
+
+void print_usage(const char *program)
+{
+    std::cerr << "usage: " << program << " [--map=NAME]... [--map-dir=DIR] [--games=N] [--seed=N] [--jobs=N]\n"
+              << "       [--timeout-ms=N] [--temp-dir=DIR] [--keep-dirs] PLAYER PLAYER [PLAYER [PLAYER]]\n"
+              << "PLAYER is [label=][lib:|exe:]path[ options], e.g. \"lib:./libbot.so --engine=alphabeta\"" << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+    std::ios_base::sync_with_stdio(false);
+    ArenaOptions options;
+    std::vector<PlayerSpec> players;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg.compare(0, 6, "--map=") == 0)
+        {
+            std::istringstream names(arg.substr(6));
+            std::string name;
+            while (std::getline(names, name, ','))
+                options.maps.push_back(name);
+        }
+        else if (arg.compare(0, 10, "--map-dir=") == 0)
+            options.map_dir = arg.substr(10);
+        else if (arg.compare(0, 8, "--games=") == 0)
+            options.games = std::max(1, std::atoi(arg.c_str() + 8));
+        else if (arg.compare(0, 7, "--seed=") == 0)
+            options.seed = std::strtoull(arg.c_str() + 7, nullptr, 10);
+        else if (arg.compare(0, 7, "--jobs=") == 0)
+            options.jobs = std::max(0, std::atoi(arg.c_str() + 7));
+        else if (arg.compare(0, 13, "--timeout-ms=") == 0)
+            options.timeout_ms = std::max(1, std::atoi(arg.c_str() + 13));
+        else if (arg.compare(0, 11, "--temp-dir=") == 0)
+            options.temp_dir = arg.substr(11);
+        else if (arg == "--keep-dirs")
+            options.keep_dirs = true;
+        else if (arg.compare(0, 2, "--") == 0)
+        {
+            std::cerr << "Error: unknown option " << arg << std::endl;
+            print_usage(argv[0]);
+            return 1;
+        }
+        else
+        {
+            PlayerSpec spec;
+            std::string error;
+            if (!parse_player_spec(arg, spec, &error))
+            {
+                std::cerr << "Error: " << error << std::endl;
+                return 1;
+            }
+            players.push_back(spec);
+        }
+    }
+    if (players.size() < 2 || players.size() > size_t(MAX_SIM_PLAYERS))
+    {
+        print_usage(argv[0]);
+        return 1;
+    }
+    if (options.maps.empty())
+        options.maps.push_back("G");
+
+    std::vector<MatchMap> maps(options.maps.size());
+    for (size_t m = 0; m < maps.size(); ++m)
+    {
+        std::string error;
+        if (!load_match_map(map_path(options, options.maps[m]), maps[m], &error))
+        {
+            std::cerr << "Error: " << error << std::endl;
+            return 1;
+        }
+    }
+
+    // Plugin copies and the executables' per-game folders all live under one root
+    if (options.temp_dir.empty())
+        options.temp_dir = std::getenv("TMPDIR") ? std::getenv("TMPDIR") : "/tmp";
+    std::string root_template = options.temp_dir + "/arena-XXXXXX";
+    if (!mkdtemp(&root_template[0]))
+    {
+        std::cerr << "Error: cannot create a folder in " << options.temp_dir << std::endl;
+        return 1;
+    }
+    const std::string root = root_template;
+
+    std::vector<ArenaGame> schedule;
+    for (size_t m = 0; m < maps.size(); ++m)
+    {
+        for (int g = 0; g < options.games; ++g)
+            schedule.push_back({int(m), options.seed + uint64_t(g)});
+    }
+
+    ThreadPool pool(options.jobs);
+    std::vector<std::unique_ptr<MatchWorker>> workers;
+    for (int w = 0; w < pool.size(); ++w)
+        workers.emplace_back(new MatchWorker(root + "/worker" + std::to_string(w), options.timeout_ms, options.keep_dirs));
+    std::vector<int> seating;
+    for (size_t p = 0; p < players.size(); ++p)
+        seating.push_back(int(p));
+    std::vector<ArenaTally> tallies(players.size());
+    std::mutex report_mutex;
+    bool failed = false;
+    int finished = 0;
+
+    std::cout << schedule.size() << " game(s) on " << pool.size() << " thread(s), results as they finish:" << std::endl;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    pool.run(int(schedule.size()),
+             [&](int task, int w)
+             {
+                 const ArenaGame &game = schedule[task];
+                 std::chrono::steady_clock::time_point game_start = std::chrono::steady_clock::now();
+                 MatchResult result;
+                 std::string error;
+                 if (!workers[w]->play(maps[game.map], players, seating, game.seed, "game" + std::to_string(task), result, &error))
+                 {
+                     std::lock_guard<std::mutex> lock(report_mutex);
+                     if (!failed)
+                         std::cerr << "Error: " << error << std::endl;
+                     failed = true;
+                     return;
+                 }
+                 double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - game_start).count();
+
+                 std::ostringstream line;
+                 line << maps[game.map].name << " seed " << game.seed << ":";
+                 std::lock_guard<std::mutex> lock(report_mutex);
+                 for (int i = 0; i < result.num_players; ++i)
+                 {
+                     ArenaTally &tally = tallies[i];
+                     ++tally.games;
+                     tally.area += result.area[i];
+                     tally.death_turn += result.death_turn[i];
+                     double score = match_score(result, i);
+                     tally.wins += score == 1.0;
+                     tally.draws += score == 0.5;
+                     tally.losses += score == 0.0;
+                     line << "  " << char('A' + i) << " " << players[i].label << " " << result.area[i] << " (died turn "
+                          << result.death_turn[i] << ")";
+                 }
+                 line << "  | " << result.turns << " turns, " << seconds << " s";
+                 std::cout << line.str() << std::endl;
+                 ++finished;
+             });
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    workers.clear(); // Unloads the plugins before their files go
+    if (!options.keep_dirs)
+        remove_directory_tree(root);
+    else
+        std::cout << "Game folders kept in " << root << std::endl;
+    if (failed)
+        return 1;
+
+    std::cout << "\n" << finished << " game(s) in " << elapsed << " s, " << (elapsed > 0 ? finished / elapsed * 3600.0 : 0.0)
+              << " games/hour. Wins go to the largest final area (findColoredArea), ties are draws.\n";
+    char header[160];
+    std::snprintf(header, sizeof(header), "%-32s %6s %6s %6s %6s %10s %10s", "player", "games", "wins", "draws", "losses",
+                  "mean area", "mean death");
+    std::cout << header << '\n';
+    for (size_t p = 0; p < players.size(); ++p)
+    {
+        const ArenaTally &tally = tallies[p];
+        char row[200];
+        double games = std::max(tally.games, 1);
+        std::snprintf(row, sizeof(row), "%-32s %6d %6d %6d %6d %10.1f %10.1f", (std::string(1, char('A' + p)) + " " + players[p].label).c_str(),
+                      tally.games, tally.wins, tally.draws, tally.losses, tally.area / games, tally.death_turn / games);
+        std::cout << row << '\n';
+    }
+    return 0;
+}
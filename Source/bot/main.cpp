@@ -1,11 +1,28 @@
 #include <bits/stdc++.h>
 
-// --- Constants ---
-const char EMPTY_CELL = '.';
-const char OBSTACLE_CELL = '#';
-const char SPEED_BOOST_ITEM = 'G';
-const char PAINT_BOMB_ITEM = 'E';
-const char OIL_SLICK_ITEM = 'F';
+#include "../common/flat_grid.h"
+#include "../common/bitboard.h"
+#include "../common/enclosure.h"
+#include "../common/distance_field.h"
+#include "../common/territory.h"
+#include "../common/item_paths.h"
+#include "../common/window_sums.h"
+#include "../common/seal_schedule.h"
+#include "../common/zobrist.h"
+#include "../common/map_parser.h"
+#include "../common/forward_model.h"
+#include "../common/opponent_model.h"
+#include "../common/mcts.h"
+#include "../common/alpha_beta.h"
+#include "../common/time_manager.h"
+#include "../common/thread_pool.h"
+#include "../common/bot_api.h"
+#include "../common/eval_weights.h"
+#include "../common/opening_book.h"
+#include "opening_book_data.h"
+#if defined(BOT_BENCH)
+#include "../common/bench.h"
+#endif
 
 // --- Helper Structs/Classes ---
 
@@ -42,8 +59,10 @@ struct ItemOnMap
 class GameState;
 struct MoveOption;
 
-double evaluate_move(GameState &gs, int next_x, int next_y, int current_x, int current_y, bool used_oil_slick_for_this_move, int steps_taken);
-MoveOption decide_move(GameState &gs);
+template <typename Policy>
+double evaluate_move(GameState &gs, const Policy &w, int next_x, int next_y, int current_x, int current_y, bool used_oil_slick_for_this_move, int steps_taken);
+template <typename Policy>
+MoveOption decide_move(GameState &gs, const Policy &w);
 std::pair<int, int> choose_initial_position(GameState &gs);
 
 class GameState
@@ -52,8 +71,21 @@ public:
     int M, N, K_shrink_period, current_turn;
     Player my_player;
     std::vector<Player> other_players;
-    std::vector<std::vector<char>> grid;
+    FlatGrid grid;
     std::vector<ItemOnMap> items_on_map; // Parsed from input
+    std::vector<int> item_index;         // Flat index -> items_on_map index, -1 for none
+    std::vector<int> item_cells;         // items_on_map index -> flat index, -1 off the board
+    BoardPlanes planes;                  // Bitboard view of grid + items_on_map
+    BitPlane opponent_cells;             // Cells occupied by live opponents
+    WindowSums paintable_sums;           // Empty or enemy cells, not blocked, no opponent on them
+    EnclosureMap enclosure;              // Board shape for the capture fill
+    SealSchedule seals;                  // Turn each cell is sealed on; built once per map
+    uint64_t board_hash;                 // Zobrist key of grid, players, items and shrink layer
+    BitPlane move_walls;                 // path_walls() for this turn
+    DistanceFields distances;            // Walking distances; outlive the turn until the walls change
+    Territory territory;                 // Scratch for my_territory_gain
+    ItemPathfinder item_paths;           // Scratch for find_path_to_nearest_item
+    OpponentModel opponents;             // Opponents' moves so far, for the searches; kept with my item state
 
     // My active items state
     int speed_boost_turns_left;
@@ -61,72 +93,144 @@ public:
     int oil_slick_turns_to_expire;  // If has_oil_slick, how many turns until it vanishes if not used
     bool has_oil_slick;             // True if player possesses an oil slick item
 
-    GameState() : M(0), N(0), K_shrink_period(0), current_turn(0),
+    GameState() : M(0), N(0), K_shrink_period(0), current_turn(0), board_hash(0),
                   speed_boost_turns_left(0), paint_bomb_just_picked_up(false),
                   oil_slick_turns_to_expire(0), has_oil_slick(false) {}
 
-    void parse_input(const std::string &filename = "MAP.INP")
+    // Parses one turn in MAP.INP format without touching the item state
+    bool parse_input_text(const char *begin, const char *end)
     {
-        std::ifstream ifs(filename);
-        if (!ifs.is_open())
+        MapInput input;
+        std::string error;
+        if (!parse_map_text(begin, end, input, grid, &error))
         {
-            std::cerr << "Error: Could not open " << filename << std::endl;
-            // In a real contest, might need to exit or throw
-            return;
+            std::cerr << "Error: Could not parse turn input: " << error << std::endl;
+            grid.reset(0, 0);
+            return false;
         }
+        apply_map_input(input);
+        return true;
+    }
 
-        ifs >> M >> N >> K_shrink_period >> current_turn;
-
-        int my_x, my_y;
-        char my_color_char;
-        ifs >> my_x >> my_y >> my_color_char;
-        my_player = Player(my_x, my_y, my_color_char);
+    // Copies everything but the grid (parse_map_text writes that in place)
+    void apply_map_input(const MapInput &input)
+    {
+        M = input.M;
+        N = input.N;
+        K_shrink_period = input.K;
+        current_turn = input.turn;
+        my_player = Player(input.me.x, input.me.y, input.me.color);
+
+        other_players.clear(); // Clear before populating
+        for (const MapPlayer &op : input.others)
+        {
+            other_players.emplace_back(op.x, op.y, op.color);
+        }
 
-        int num_other_players;
-        ifs >> num_other_players;
-        other_players.clear(); // Clear before resizing/populating
-        for (int i = 0; i < num_other_players; ++i)
+        items_on_map.clear(); // Clear before populating
+        for (const MapItem &map_item : input.items)
         {
-            int p_x, p_y;
-            char p_color;
-            ifs >> p_x >> p_y >> p_color;
-            other_players.emplace_back(p_x, p_y, p_color);
+            items_on_map.push_back({map_item.r, map_item.c, map_item.type});
         }
+        build_planes();
+        board_hash = compute_board_hash();
+    }
 
-        grid.assign(M, std::vector<char>(N)); // Resize and initialize
-        for (int i = 0; i < M; ++i)
+    // Next ring Board.shrink will seal, as far as the turn number tells
+    int shrink_radius() const
+    {
+        return (current_turn > 0 && K_shrink_period > 0) ? (current_turn - 1) / K_shrink_period : 0;
+    }
+
+    // Uses the SimState keys, so position_hash() ^ turn_key(current_turn) is
+    // make_sim_state(*this).hash
+    uint64_t compute_board_hash() const
+    {
+        const ZobristKeys &keys = zobrist_keys();
+        uint64_t h = keys.radius_key(shrink_radius());
+        for (int r = 0; r < M; ++r)
         {
-            for (int j = 0; j < N; ++j)
-            {
-                ifs >> grid[i][j];
-            }
+            int idx = grid.idx(r, 0);
+            for (int c = 0; c < N; ++c, ++idx)
+                h ^= keys.cell_key(idx, grid[idx]);
         }
+        auto add_player = [&](const Player &p)
+        {
+            int k = color_index(p.color_char);
+            if (k >= 0 && !p.eliminated && is_within_bounds(p.x, p.y))
+                h ^= keys.player[k][grid.idx(p.x, p.y)];
+        };
+        add_player(my_player);
+        for (const auto &op : other_players)
+            add_player(op);
+        for (const auto &item : items_on_map)
+        {
+            if (is_within_bounds(item.r, item.c))
+                h ^= keys.item_key(grid.idx(item.r, item.c), item.type);
+        }
+        return h;
+    }
 
-        int num_map_items;
-        ifs >> num_map_items;
-        items_on_map.clear(); // Clear before populating
-        for (int i = 0; i < num_map_items; ++i)
+    // My power-up and its counter as the simulator keeps them. STATE.DAT
+    // counters are saved after this bot's own decrement, one behind the
+    // simulator's tangtoc / dautron.
+    void my_sim_powerup(int &kind, int &turns) const
+    {
+        kind = POWERUP_NONE;
+        turns = 0;
+        if (speed_boost_turns_left > 0)
         {
-            ItemOnMap item;
-            ifs >> item.r >> item.c >> item.type;
-            items_on_map.push_back(item);
+            kind = POWERUP_SPEED_BOOST;
+            turns = std::min(speed_boost_turns_left + 1, POWERUP_DURATION);
         }
-        ifs.close();
-        load_my_item_state(); // Load persistent state after parsing current turn's map
+        else if (has_oil_slick && oil_slick_turns_to_expire > 0)
+        {
+            kind = POWERUP_OIL_SLICK;
+            turns = std::min(oil_slick_turns_to_expire + 1, POWERUP_DURATION);
+        }
+    }
+
+    // Turns every item on the map has left, counting this one; they all
+    // spawned on the same shrink
+    int item_timeout() const
+    {
+        if (current_turn > 0 && K_shrink_period > 0)
+            return K_shrink_period - (current_turn - 1) % K_shrink_period;
+        return K_shrink_period;
+    }
+
+    // My power-up as the simulator counts it (see make_sim_state)
+    uint64_t my_item_key() const
+    {
+        int k = color_index(my_player.color_char);
+        if (k < 0)
+            return 0;
+        int kind, turns;
+        my_sim_powerup(kind, turns);
+        return zobrist_keys().powerup_key(k, kind, turns);
+    }
+
+    // Position key without the turn, so the same position on two turns collides.
+    // The item state is folded in on demand since it changes after parsing.
+    uint64_t position_hash() const
+    {
+        return board_hash ^ my_item_key();
     }
 
     void save_my_item_state(const std::string &filename = "STATE.DAT")
     {
-        std::ofstream ofs(filename);
-        if (!ofs.is_open())
+        if (!write_file_atomically(filename, my_item_state_text()))
         {
             std::cerr << "Warning: Could not write to " << filename << std::endl;
-            return;
         }
-        ofs << speed_boost_turns_left << std::endl;
-        ofs << oil_slick_turns_to_expire << std::endl;
-        ofs << (has_oil_slick ? 1 : 0) << std::endl;
-        ofs.close();
+    }
+
+    // Three lines of item state, then the opponent model's line if it has one
+    std::string my_item_state_text() const
+    {
+        std::string model = opponents.format();
+        return std::to_string(speed_boost_turns_left) + "\n" + std::to_string(oil_slick_turns_to_expire) + "\n" +
+               (has_oil_slick ? "1" : "0") + "\n" + (model.empty() ? "" : model + "\n");
     }
 
     void load_my_item_state(const std::string &filename = "STATE.DAT")
@@ -135,10 +239,8 @@ public:
         if (!ifs.is_open())
         {
             // File not found (e.g., first turn) or unreadable
-            speed_boost_turns_left = 0;
-            oil_slick_turns_to_expire = 0;
-            has_oil_slick = false;
-            paint_bomb_just_picked_up = false; // Ensure reset
+            reset_my_item_state();
+            opponents.reset();
             return;
         }
         int has_oil_slick_int = 0; // Default to 0 if read fails
@@ -154,47 +256,144 @@ public:
             oil_slick_turns_to_expire = 0; // Also reset related timer
         }
         paint_bomb_just_picked_up = false; // Reset this flag at the start of each turn's state load
+        std::string model;
+        std::getline(ifs >> std::ws, model);
+        opponents.parse(model);
         ifs.close();
     }
 
-    bool is_within_bounds(int r, int c) const
+    void reset_my_item_state()
     {
-        return r >= 0 && r < M && c >= 0 && c < N;
+        speed_boost_turns_left = 0;
+        oil_slick_turns_to_expire = 0;
+        has_oil_slick = false;
+        paint_bomb_just_picked_up = false; // Ensure reset
     }
 
-    // Checks if a cell (r, c) will be sealed at the END of the current turn
-    bool cell_will_be_sealed_this_turn(int r, int c) const
+    void build_planes()
     {
-        if (current_turn > 0 && K_shrink_period > 0 && current_turn % K_shrink_period == 0)
+        planes.build(grid);
+        if (!enclosure.matches(grid))
+            enclosure.build(grid);
+        if (!seals.matches(grid, K_shrink_period))
+            seals.build(grid, K_shrink_period);
+        // The regular schedule: this bot only gets a turn while it is alive
+        seals.set_turn(current_turn, shrink_radius());
+        item_index.assign(grid.padded_size(), -1);
+        item_cells.assign(items_on_map.size(), -1);
+        for (int i = 0; i < int(items_on_map.size()); ++i)
         {
-            int sealed_layer_index = (current_turn / K_shrink_period) - 1;
-            // Ensure sealed_layer_index is not negative, though (current_turn / K_shrink_period) should be >= 1 here
-            if (sealed_layer_index < 0)
-                sealed_layer_index = 0;
+            const ItemOnMap &item = items_on_map[i];
+            if (is_within_bounds(item.r, item.c))
+            {
+                planes.items.set(grid.idx(item.r, item.c));
+                item_index[grid.idx(item.r, item.c)] = i;
+                item_cells[i] = grid.idx(item.r, item.c);
+            }
+        }
+        opponent_cells.clear_all();
+        for (const auto &op : other_players)
+        {
+            if (!op.eliminated && is_within_bounds(op.x, op.y))
+                opponent_cells.set(grid.idx(op.x, op.y));
+        }
+        move_walls = path_walls();
+        distances.set_walls(grid, move_walls);
 
-            return (r == sealed_layer_index || r == M - 1 - sealed_layer_index ||
-                    c == sealed_layer_index || c == N - 1 - sealed_layer_index);
+        BitPlane paintable;
+        const BitPlane &mine = my_color_cells();
+        for (int w = 0; w < planes.num_words; ++w)
+        {
+            uint64_t colored = 0;
+            for (int k = 0; k < NUM_COLORS; ++k)
+                colored |= planes.color[k].words[w];
+            paintable.words[w] = (planes.empty.words[w] | (colored & ~mine.words[w])) &
+                                 ~planes.blocked.words[w] & ~opponent_cells.words[w];
         }
-        return false;
+        paintable_sums.build(grid, paintable);
     }
 
-    bool is_valid_for_move(int r, int c, bool can_pass_one_obstacle = false) const
+    // Cells a path may not enter this turn: blocked cells plus the ring that
+    // seals at the end of it (is_valid_for_move without oil). The ring is
+    // blocked from the next turn on, so the walls stay the same until the
+    // following shrink.
+    BitPlane path_walls() const
     {
-        if (!is_within_bounds(r, c))
+        BitPlane walls = planes.blocked;
+        if (current_turn > 0 && K_shrink_period > 0 && current_turn % K_shrink_period == 0)
         {
-            return false;
+            for (int r = 0; r < M; ++r)
+            {
+                for (int c = 0; c < N; ++c)
+                {
+                    if (cell_will_be_sealed_this_turn(r, c))
+                        walls.set(grid.idx(r, c));
+                }
+            }
         }
+        return walls;
+    }
+
+    // Empty and enemy cells I reach before every opponent when I stand on
+    // (r, c) with `boost_turns` of speed boost left and they stay put
+    int my_territory_gain(int r, int c, int boost_turns)
+    {
+        TerritorySource sources[MAX_TERRITORY_PLAYERS];
+        int num_sources = 0;
+        sources[num_sources++] = {grid.idx(r, c), boost_turns, my_player.color_char};
+        for (const auto &op : other_players)
+        {
+            if (num_sources == MAX_TERRITORY_PLAYERS)
+                break;
+            bool alive = !op.eliminated && is_within_bounds(op.x, op.y);
+            sources[num_sources++] = {alive ? grid.idx(op.x, op.y) : -1, 0, op.color_char};
+        }
+        territory.compute(grid, sources, num_sources, [&](int idx) { return move_walls.test(idx); });
+        return territory.gain[0];
+    }
+
+    // Steps from the map centre to (r, c), or -1 if walls cut it off
+    int distance_to_center(int r, int c)
+    {
+        return distances.distance(grid.idx(M / 2, N / 2), grid.idx(r, c));
+    }
+
+    // Plane of my own colour, or an empty plane if my colour is unknown
+    const BitPlane &my_color_cells() const
+    {
+        static const BitPlane no_cells;
+        int k = color_index(my_player.color_char);
+        return k >= 0 ? planes.color[k] : no_cells;
+    }
+
+    bool is_within_bounds(int r, int c) const
+    {
+        return r >= 0 && r < M && c >= 0 && c < N;
+    }
 
-        char cell_content = grid[r][c];
-        bool is_obstacle_type = (cell_content == OBSTACLE_CELL || (cell_content >= 'a' && cell_content <= 'd'));
+    // Checks if a cell (r, c) will be sealed at the END of the current turn.
+    // (r, c) may lie up to GRID_PAD cells outside the board.
+    bool cell_will_be_sealed_this_turn(int r, int c) const
+    {
+        return seals.seal_turn(grid.idx(r, c)) == current_turn;
+    }
 
-        if (is_obstacle_type)
+    // (r, c) may lie up to GRID_PAD cells outside the board; the sentinel frame rejects it.
+    bool is_valid_for_move(int r, int c, bool can_pass_one_obstacle = false) const
+    {
+        return is_valid_for_move_idx(grid.idx(r, c), can_pass_one_obstacle);
+    }
+
+    bool is_valid_for_move_idx(int idx, bool can_pass_one_obstacle = false) const
+    {
+        if (planes.blocked.test(idx))
         {
-            return can_pass_one_obstacle; // Allow if oil slick is active for this specific step
+            // Allow if oil slick is active for this specific step, but never off the board
+            return can_pass_one_obstacle && grid[idx] != BORDER_CELL;
         }
 
         // Crucial: Check if landing on this cell means elimination due to shrinking THIS turn
-        if (cell_will_be_sealed_this_turn(r, c))
+        if (cell_will_be_sealed_this_turn(grid.row_of(idx), grid.col_of(idx)))
         {
             return false;
         }
@@ -213,13 +412,11 @@ public:
 
         char picked_up_item_char = 0; // Use 0 or a specific null char to indicate no item
         // Find item on map (the game engine removes it from map for next turn's MAP.INP, we just update our status)
-        for (const auto &item : items_on_map)
+        if (is_within_bounds(next_x, next_y))
         {
-            if (item.r == next_x && item.c == next_y)
-            {
-                picked_up_item_char = item.type;
-                break; // Found the item at the target location
-            }
+            int item = item_index[grid.idx(next_x, next_y)];
+            if (item >= 0)
+                picked_up_item_char = items_on_map[item].type;
         }
 
         if (picked_up_item_char != 0)
@@ -227,7 +424,7 @@ public:
             // std::cerr << "DEBUG: Picked up " << picked_up_item_char << " at (" << next_x << "," << next_y << ")" << std::endl;
             if (picked_up_item_char == SPEED_BOOST_ITEM)
             {
-                speed_boost_turns_left = 5; // "tự động kích hoạt ... hiệu lực sau 5 lượt"
+                speed_boost_turns_left = StandardRules::BOOST_TURNS; // "tự động kích hoạt ... hiệu lực sau 5 lượt"
             }
             else if (picked_up_item_char == PAINT_BOMB_ITEM)
             {
@@ -237,7 +434,7 @@ public:
             else if (picked_up_item_char == OIL_SLICK_ITEM)
             {
                 has_oil_slick = true;
-                oil_slick_turns_to_expire = 5; // "nếu sau 5 lượt ... không kích hoạt thì ... biến mất"
+                oil_slick_turns_to_expire = StandardRules::OIL_TURNS; // "nếu sau 5 lượt ... không kích hoạt thì ... biến mất"
             }
         }
     }
@@ -276,54 +473,126 @@ public:
     }
 };
 
+// --- Forward Model Bridge ---
+
+// Builds the simulator's view of this turn from what MAP.INP and STATE.DAT tell
+// us. Item timeouts and the shrink radius follow from the turn number alone.
+// Opponents' power-ups and everyone's last speed-boost mid cell are not in the
+// input, so they start out empty.
+SimState make_sim_state(const GameState &gs)
+{
+    SimState s;
+    s.grid = gs.grid;
+    s.turn = gs.current_turn;
+    s.K = gs.K_shrink_period;
+    s.radius = gs.shrink_radius();
+
+    for (int k = 0; k < MAX_SIM_PLAYERS; ++k)
+        s.players[k] = {-1, false, char('A' + k), 0, 0, POWERUP_NONE, -1};
+    auto add_player = [&](const Player &p)
+    {
+        int k = color_index(p.color_char);
+        if (k < 0 || k >= MAX_SIM_PLAYERS)
+            return;
+        SimPlayer &sp = s.players[k];
+        sp.alive = !p.eliminated && gs.is_within_bounds(p.x, p.y);
+        sp.pos = sp.alive ? gs.grid.idx(p.x, p.y) : -1;
+        s.num_players = std::max(s.num_players, k + 1);
+    };
+    add_player(gs.my_player);
+    for (const auto &op : gs.other_players)
+        add_player(op);
+
+    int me = color_index(gs.my_player.color_char);
+    if (me >= 0 && me < MAX_SIM_PLAYERS)
+    {
+        SimPlayer &sp = s.players[me];
+        int kind, turns;
+        gs.my_sim_powerup(kind, turns);
+        sp.powerup = uint8_t(kind);
+        if (kind == POWERUP_SPEED_BOOST)
+            sp.boost_turns = int8_t(turns);
+        else if (kind == POWERUP_OIL_SLICK)
+            sp.oil_turns = int8_t(turns);
+    }
+
+    int timeout = gs.item_timeout();
+    for (const auto &item : gs.items_on_map)
+    {
+        if (gs.is_within_bounds(item.r, item.c))
+            s.add_item(gs.grid.idx(item.r, item.c), item.type, timeout);
+    }
+    s.rehash();
+    return s;
+}
+
 // --- Core Bot Logic (Functions) ---
 
 std::pair<int, int> choose_initial_position(GameState &gs)
 {
-    // Generate random valid starting position
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<int> dist_x(0, gs.M - 1);
-    std::uniform_int_distribution<int> dist_y(0, gs.N - 1);
-    
-    // Try to find a valid random position
-    int max_attempts = 100; // Avoid infinite loop
-    for (int attempt = 0; attempt < max_attempts; ++attempt) {
-        int rand_x = dist_x(gen);
-        int rand_y = dist_y(gen);
-        
-        // Check if this position is valid
-        if (gs.grid[rand_x][rand_y] == EMPTY_CELL && 
-            gs.is_valid_for_move(rand_x, rand_y, false)) {
-            return {rand_x, rand_y};
-        }
-    }
-    
-    // Fallback: If no valid random position found after attempts, 
-    // search systematically for any valid position
-    for (int r = 0; r < gs.M; ++r) {
-        for (int c = 0; c < gs.N; ++c) {
-            if (gs.grid[r][c] == EMPTY_CELL && 
-                gs.is_valid_for_move(r, c, false)) {
-                return {r, c};
-            }
-        }
-    }
-    
+    // The opening book's cell for this map, or the best by rank_start_cells
+    // on a map it does not know
+    int start = opening_start(OPENING_BOOK, gs.grid, gs.K_shrink_period);
+    if (start >= 0)
+        return {gs.grid.row_of(start), gs.grid.col_of(start)};
+
     // Last resort: return center position
     return {gs.M / 2, gs.N / 2};
 }
 
-double evaluate_move(GameState &gs, int next_x, int next_y, int current_x, int current_y, bool used_oil_slick_for_this_move, int steps_taken)
+// --- Evaluation Weights ---
+//
+// Everything evaluate_move and decide_move score a move with, in the order
+// of WEIGHTS below. Source/tuner --write rewrites the numbers in this table.
+// DefaultWeights compiles them into evaluate_move (see eval_weights.h), which
+// drops the terms weighted 0 and the work behind them.
+
+enum BotWeight
 {
-    double score = 0.0;
-    char my_color = gs.my_player.color_char;
+    W_ITEM_PICKUP,       // Picking up any item
+    W_BOMB_PICKUP,       // On top, for a paint bomb
+    W_SPEED_PICKUP,      // On top, for a speed boost
+    W_OIL_PICKUP,        // On top, for an oil slick
+    W_BOMB_CELL,         // Per cell a picked-up bomb paints
+    W_BOOST_USE,         // Moving two cells with the speed boost
+    W_OIL_USE,           // Crossing an obstacle with the oil slick
+    W_CAPTURED_CELL,     // Per cell the move encloses
+    W_ENCLOSED_OPPONENT, // Per opponent inside the enclosure
+    W_STAY_PENALTY,      // Standing still
+    W_SHRINK_PENALTY,    // Per turn inside the last period before the cell is sealed
+    W_TERRITORY_CELL,    // Per cell I reach before anyone else
+    W_CENTER_PENALTY,    // Per step from the centre
+    W_ITEM_ROUTE,        // decide_move: first step towards the nearest item
+    NUM_WEIGHTS
+};
 
-    if (!gs.is_within_bounds(next_x, next_y))
-        return -std::numeric_limits<double>::infinity();
+constexpr EvalParam WEIGHTS[NUM_WEIGHTS] = {
+    {"item_pickup", 15830.0},
+    {"bomb_pickup", 1152.0},
+    {"speed_pickup", 961.6},
+    {"oil_pickup", 631.5},
+    {"bomb_cell", 1.73},
+    {"boost_use", 24770.0},
+    {"oil_use", 9726.0},
+    {"captured_cell", 4.593},
+    {"enclosed_opponent", 249.3},
+    {"stay_penalty", 0.08264},
+    {"shrink_penalty", 0.0},
+    {"territory_cell", 0.3544},
+    {"center_penalty", 0.005582},
+    {"item_route", 1296000.0},
+};
 
-    char target_cell_on_grid_char = gs.grid[next_x][next_y];
-    if (target_cell_on_grid_char == OBSTACLE_CELL || (target_cell_on_grid_char >= 'a' && target_cell_on_grid_char <= 'd'))
+typedef FixedWeights<WEIGHTS> DefaultWeights;
+
+template <typename Policy>
+double evaluate_move(GameState &gs, const Policy &w, int next_x, int next_y, int current_x, int current_y, bool used_oil_slick_for_this_move, int steps_taken)
+{
+    double score = 0.0;
+
+    // Off-board targets read the sentinel frame, which counts as blocked
+    int target_idx = gs.grid.idx(next_x, next_y);
+    if (gs.planes.blocked.test(target_idx))
     {
         return -std::numeric_limits<double>::infinity();
     }
@@ -332,98 +601,65 @@ double evaluate_move(GameState &gs, int next_x, int next_y, int current_x, int c
         return -std::numeric_limits<double>::infinity();
     }
 
-    bool item_action_taken = false;
-
     // 1. Item Pickup Priority (Highest)
     bool can_pickup_new_item = !(gs.speed_boost_turns_left > 0 || gs.has_oil_slick);
     char item_at_target_type = 0; 
 
-    if (can_pickup_new_item)
+    if (can_pickup_new_item && gs.planes.items.test(target_idx))
     {
-        for (const auto &item_on_map : gs.items_on_map)
-        {
-            if (item_on_map.r == next_x && item_on_map.c == next_y)
-            {
-                item_at_target_type = item_on_map.type;
-                break;
-            }
-        }
+        item_at_target_type = gs.items_on_map[gs.item_index[target_idx]].type;
     }
 
     if (item_at_target_type != 0)
     {
-        score += 20000.0; // Massive base score for picking up any item
-        item_action_taken = true;
+        score += w[W_ITEM_PICKUP]; // Massive base score for picking up any item
         if (item_at_target_type == PAINT_BOMB_ITEM)
-            score += 1000.0; // Additional small bonus for paint bomb
+            score += w[W_BOMB_PICKUP]; // Additional small bonus for paint bomb
         else if (item_at_target_type == SPEED_BOOST_ITEM)
-            score += 800.0;  // Additional small bonus for speed boost
+            score += w[W_SPEED_PICKUP]; // Additional small bonus for speed boost
         else if (item_at_target_type == OIL_SLICK_ITEM)
-            score += 700.0;  // Additional small bonus for oil slick
+            score += w[W_OIL_PICKUP]; // Additional small bonus for oil slick
 
-        if (item_at_target_type == PAINT_BOMB_ITEM)
+        if (item_at_target_type == PAINT_BOMB_ITEM && w[W_BOMB_CELL] != 0.0)
         {
-            int bomb_gain = 0;
-            for (int dr_bomb = -2; dr_bomb <= 2; ++dr_bomb)
-            { 
-                for (int dc_bomb = -2; dc_bomb <= 2; ++dc_bomb)
-                {
-                    int bomb_r = next_x + dr_bomb;
-                    int bomb_c = next_y + dc_bomb;
-                    if (gs.is_within_bounds(bomb_r, bomb_c))
-                    {
-                        char cell_char_in_bomb_area = gs.grid[bomb_r][bomb_c];
-                        bool cell_is_paintable_by_bomb = true;
-
-                        if (cell_char_in_bomb_area == OBSTACLE_CELL || (cell_char_in_bomb_area >= 'a' && cell_char_in_bomb_area <= 'd'))
-                        {
-                            cell_is_paintable_by_bomb = false;
-                        }
-                        
-                        int players_on_bombed_cell = 0;
-                        bool other_player_on_bombed_cell = false;
-
-                        if (!gs.my_player.eliminated && gs.my_player.x == bomb_r && gs.my_player.y == bomb_c)
-                        {
-                            players_on_bombed_cell++;
-                        }
-                        for (const auto &op : gs.other_players)
-                        {
-                            if (!op.eliminated && op.x == bomb_r && op.y == bomb_c)
-                            {
-                                players_on_bombed_cell++;
-                                other_player_on_bombed_cell = true;
-                            }
-                        }
-
-                        if (other_player_on_bombed_cell || players_on_bombed_cell > 1)
-                        {
-                            cell_is_paintable_by_bomb = false;
-                        }
-
-                        if (cell_is_paintable_by_bomb && cell_char_in_bomb_area != my_color)
-                        { 
-                            bomb_gain++;
-                        }
-                    }
-                }
-            }
-            score += bomb_gain * 2.0; // Reduced multiplier, base pickup score is dominant
+            // Opponents standing inside the blast keep their cell's colour
+            // Counts empty and enemy cells in the bomb's square, clipped to the board
+            int bomb_gain = gs.paintable_sums.count_around(next_x, next_y, Policy::BOMB_RADIUS);
+            score += bomb_gain * w[W_BOMB_CELL]; // Reduced multiplier, base pickup score is dominant
         }
     }
 
     // 2. Item Usage Priority (Second Highest)
     if (steps_taken == 2) { // Implies speed boost usage
-        score += 15000.0;
-        item_action_taken = true;
+        score += w[W_BOOST_USE];
     }
     if (used_oil_slick_for_this_move)
     {
-        score += 15000.0; // Same high score for using oil slick
-        item_action_taken = true;
+        score += w[W_OIL_USE];
     }
 
 
+    // 3. Enclosure: cells (and opponents) cut off from the edge once the cells
+    // this move paints join my colour
+    if (w[W_CAPTURED_CELL] != 0.0 || w[W_ENCLOSED_OPPONENT] != 0.0)
+    {
+        BitPlane my_walls = gs.my_color_cells();
+        my_walls.set(target_idx);
+        if (steps_taken == 2)
+            my_walls.set(gs.grid.idx((current_x + next_x) / 2, (current_y + next_y) / 2));
+        BitPlane enclosed;
+        int captured = gs.enclosure.captured_cells(my_walls, gs.planes.blocked, enclosed);
+        if (captured > 0)
+        {
+            score += captured * w[W_CAPTURED_CELL];
+            for (const auto &op : gs.other_players)
+            {
+                if (!op.eliminated && gs.is_within_bounds(op.x, op.y) && enclosed.test(gs.grid.idx(op.x, op.y)))
+                    score += w[W_ENCLOSED_OPPONENT]; // Captured cells kill whoever stands on them
+            }
+        }
+    }
+
     // // 3. Coloring Tiles (Much lower priority, only if no item action)
     // if (!item_action_taken) { // Only consider these if no item pickup/usage
     //     if (target_cell_on_grid_char == EMPTY_CELL)
@@ -443,15 +679,13 @@ double evaluate_move(GameState &gs, int next_x, int next_y, int current_x, int c
 
     if (next_x == current_x && next_y == current_y)
     {                 // Staying put
-        score -= 0.1; // Slight penalty, less significant now
+        score -= w[W_STAY_PENALTY]; // Slight penalty, less significant now
     }
 
     // 4. Positional Advantages / Disadvantages (Minor impact)
-    int s_level_next = std::min({next_x, gs.M - 1 - next_x, next_y, gs.N - 1 - next_y});
-    if (gs.K_shrink_period > 0)
+    if (gs.K_shrink_period > 0 && w[W_SHRINK_PENALTY] != 0.0)
     { 
-        int turn_of_shrink_for_target_layer = (s_level_next + 1) * gs.K_shrink_period;
-        int turns_until_shrink = turn_of_shrink_for_target_layer - gs.current_turn; 
+        int turns_until_shrink = gs.seals.seal_turn(target_idx) - gs.current_turn;
 
         if (turns_until_shrink <= 0)
         {
@@ -459,13 +693,25 @@ double evaluate_move(GameState &gs, int next_x, int next_y, int current_x, int c
         }
         else if (turns_until_shrink <= gs.K_shrink_period)
         {
-            score -= (gs.K_shrink_period - turns_until_shrink + 1) * 0.8; // Was 8.0
+            score -= (gs.K_shrink_period - turns_until_shrink + 1) * w[W_SHRINK_PENALTY];
         }
     }
 
-    int dist_to_center_r = std::abs(next_x - gs.M / 2);
-    int dist_to_center_c = std::abs(next_y - gs.N / 2);
-    score -= (dist_to_center_r + dist_to_center_c) * 0.1; // Was 1.0
+    // Room to paint: cells I would get to before anyone else from here
+    if (w[W_TERRITORY_CELL] != 0.0)
+    {
+        int boost_after_move = std::max(0, gs.speed_boost_turns_left - 1);
+        score += gs.my_territory_gain(next_x, next_y, boost_after_move) * w[W_TERRITORY_CELL];
+    }
+
+    // Walking distance around walls; straight-line if they cut the centre off
+    if (w[W_CENTER_PENALTY] != 0.0)
+    {
+        int dist_to_center = gs.distance_to_center(next_x, next_y);
+        if (dist_to_center < 0)
+            dist_to_center = std::abs(next_x - gs.M / 2) + std::abs(next_y - gs.N / 2);
+        score -= dist_to_center * w[W_CENTER_PENALTY];
+    }
 
     // // 5. Aggression/Defense (Minor impact, only if no item action)
     // if (!item_action_taken) {
@@ -502,94 +748,49 @@ struct MoveOption
         : x(_x), y(_y), oil_used(_oil), steps(_s), score(_scr) {}
 };
 
-// Find the first step toward the nearest item using BFS
-std::pair<bool, std::pair<int, int>> find_path_to_nearest_item(const GameState &gs) {
-    int my_x = gs.my_player.x;
-    int my_y = gs.my_player.y;
-    
-    // If we can't pick up a new item or there are no items, don't bother
-    bool can_pickup_new_item = !(gs.speed_boost_turns_left > 0 || gs.has_oil_slick);
-    if (!can_pickup_new_item || gs.items_on_map.empty()) {
-        return {false, {0, 0}};
-    }
-    
-    // BFS queue stores: {x, y, parent_x, parent_y}
-    std::queue<std::tuple<int, int, int, int>> q;
-    std::vector<std::vector<bool>> visited(gs.M, std::vector<bool>(gs.N, false));
-    std::vector<std::vector<std::pair<int, int>>> parent(gs.M, std::vector<std::pair<int, int>>(gs.N, {-1, -1}));
-    
-    // Start BFS
-    q.push({my_x, my_y, -1, -1});
-    visited[my_x][my_y] = true;
-    
-    std::pair<int, int> item_pos = {-1, -1};
-    
-    // BFS to find the nearest item
-    while (!q.empty() && item_pos.first == -1) {
-        auto [curr_x, curr_y, par_x, par_y] = q.front();
-        q.pop();
-        
-        // Check if current cell has an item
-        for (const auto &item : gs.items_on_map) {
-            if (item.r == curr_x && item.c == curr_y) {
-                item_pos = {curr_x, curr_y};
-                parent[curr_x][curr_y] = {par_x, par_y};
-                break;
-            }
-        }
-        
-        if (item_pos.first != -1) break; // Item found
-        
-        // Try all directions
-        for (const auto &dir : DIRECTIONS) {
-            if (dir.dr == 0 && dir.dc == 0) continue; // Skip staying put
-            
-            int next_x = curr_x + dir.dr;
-            int next_y = curr_y + dir.dc;
-            
-            if (gs.is_valid_for_move(next_x, next_y, false) && !visited[next_x][next_y]) {
-                q.push({next_x, next_y, curr_x, curr_y});
-                parent[next_x][next_y] = {curr_x, curr_y};
-                visited[next_x][next_y] = true;
-            }
-        }
+// Route to the item I can pick up soonest, counting speed boost double steps,
+// oil slick steps onto '#', item timeouts and the shrink schedule. turns is -1
+// if no item can be had in time.
+ItemRoute find_path_to_nearest_item(GameState &gs) {
+    const FlatGrid &grid = gs.grid;
+    ItemRoute none = {-1, -1, false};
+    if (gs.items_on_map.empty() || !gs.is_within_bounds(gs.my_player.x, gs.my_player.y)) {
+        return none;
     }
-    
-    // If item found, trace back to find first step
-    if (item_pos.first != -1) {
-        int x = item_pos.first;
-        int y = item_pos.second;
-        
-        // Trace back to find the first step from our position
-        while (parent[x][y].first != my_x || parent[x][y].second != my_y) {
-            // If we somehow hit the start (shouldn't happen if BFS found a path)
-            if (parent[x][y].first == -1 || parent[x][y].second == -1) {
-                return {false, {0, 0}};
-            }
-            
-            // Move back one step
-            int new_x = parent[x][y].first;
-            int new_y = parent[x][y].second;
-            x = new_x;
-            y = new_y;
-        }
-        
-        // We now have the first step from our position
-        return {true, {x, y}};
+    // Standing on an item already
+    if (gs.planes.items.test(grid.idx(gs.my_player.x, gs.my_player.y))) {
+        return none;
     }
-    
-    return {false, {0, 0}}; // No path found
+
+    ItemPathStart start;
+    start.pos = grid.idx(gs.my_player.x, gs.my_player.y);
+    gs.my_sim_powerup(start.powerup, start.turns);
+    start.turn = gs.current_turn;
+    start.K = gs.K_shrink_period;
+    gs.item_paths.search(grid, gs.seals, start, gs.item_cells.data(), int(gs.item_cells.size()), gs.item_timeout());
+
+    int nearest = gs.item_paths.nearest();
+    return nearest >= 0 ? gs.item_paths.route(nearest) : none;
 }
 
-MoveOption decide_move(GameState &gs)
+template <typename Policy>
+MoveOption decide_move(GameState &gs, const Policy &w)
 {
     int my_current_x = gs.my_player.x;
     int my_current_y = gs.my_player.y;
 
     std::vector<MoveOption> candidate_options;
 
-    // First, find the best path to the nearest item using BFS
-    auto [found_path, next_step] = find_path_to_nearest_item(gs);
+    // First, find the best path to the nearest item. It is only chased while
+    // I hold nothing: following it while a power-up ran out (instead of
+    // painting with it) lost clearly in self-play.
+    ItemRoute item_route = find_path_to_nearest_item(gs);
+    bool can_pickup_new_item = !(gs.speed_boost_turns_left > 0 || gs.has_oil_slick);
+    bool found_path = item_route.turns >= 0 && can_pickup_new_item;
+    std::pair<int, int> next_step = {-1, -1};
+    if (found_path) {
+        next_step = {gs.grid.row_of(item_route.first_pos), gs.grid.col_of(item_route.first_pos)};
+    }
 
     // --- 1-step moves (including stay) ---
     for (const auto &dir : DIRECTIONS)
@@ -604,17 +805,17 @@ MoveOption decide_move(GameState &gs)
             // If this is the first step toward the nearest item, give it a massive score boost
             double bonus_score = 0;
             if (found_path && next_r == next_step.first && next_c == next_step.second) {
-                bonus_score = 1000000.0; // Extremely high priority for moving toward items
+                bonus_score = w[W_ITEM_ROUTE]; // Extremely high priority for moving toward items
             }
             candidate_options.emplace_back(next_r, next_c, false, steps, bonus_score);
         }
         
         // Handle oil slick for 1-step moves through obstacles
         if (gs.has_oil_slick && gs.oil_slick_turns_to_expire > 0) {
-            // Check if this direction would go through an obstacle
-            if (gs.is_within_bounds(next_r, next_c)) {
-                char cell = gs.grid[next_r][next_c];
-                bool is_obstacle = (cell == OBSTACLE_CELL || (cell >= 'a' && cell <= 'd'));
+            // Check if this direction would go through an obstacle (never the sentinel frame)
+            char cell = gs.grid.at(next_r, next_c);
+            if (cell != BORDER_CELL) {
+                bool is_obstacle = is_blocked_cell(cell);
                 
                 if (is_obstacle && !gs.cell_will_be_sealed_this_turn(next_r, next_c)) {
                     // Try to find a valid landing spot after the obstacle
@@ -625,7 +826,7 @@ MoveOption decide_move(GameState &gs)
                         // Check if this gets us to or closer to an item
                         double bonus_score = 0;
                         if (found_path && (final_r == next_step.first && final_c == next_step.second)) {
-                            bonus_score = 1000000.0;
+                            bonus_score = w[W_ITEM_ROUTE];
                         }
                         candidate_options.emplace_back(final_r, final_c, true, 2, bonus_score);
                     }
@@ -653,7 +854,7 @@ MoveOption decide_move(GameState &gs)
             { // Final step must be valid
                 double bonus_score = 0;
                 if (found_path && final_r == next_step.first && final_c == next_step.second) {
-                    bonus_score = 1000000.0; // Prioritize moves that reach the item faster
+                    bonus_score = w[W_ITEM_ROUTE]; // Prioritize moves that reach the item faster
                 }
                 candidate_options.emplace_back(final_r, final_c, false, 2, bonus_score);
             }
@@ -666,13 +867,10 @@ MoveOption decide_move(GameState &gs)
     std::vector<MoveOption> valid_landings_options;
     for (const auto &opt : candidate_options)
     {
-        if (!gs.is_within_bounds(opt.x, opt.y))
-            continue;
-
-        char landing_cell_char = gs.grid[opt.x][opt.y];
-        if (landing_cell_char == OBSTACLE_CELL || (landing_cell_char >= 'a' && landing_cell_char <= 'd'))
+        char landing_cell_char = gs.grid.at(opt.x, opt.y);
+        if (is_blocked_cell(landing_cell_char))
         {
-            continue; // Cannot land on an obstacle or sealed cell
+            continue; // Cannot land on an obstacle, sealed cell or off the board
         }
         if (gs.cell_will_be_sealed_this_turn(opt.x, opt.y))
         {
@@ -693,7 +891,7 @@ MoveOption decide_move(GameState &gs)
     for (auto &opt : valid_landings_options)
     { // Use reference to modify score in place
         // Add the evaluation score to any existing bonus score from pathfinding
-        opt.score += evaluate_move(gs, opt.x, opt.y, my_current_x, my_current_y, opt.oil_used, opt.steps);
+        opt.score += evaluate_move(gs, w, opt.x, opt.y, my_current_x, my_current_y, opt.oil_used, opt.steps);
     }
 
     // Sort to find the best move: higher score first.
@@ -728,7 +926,7 @@ MoveOption decide_move(GameState &gs)
     if (valid_landings_options.empty() || valid_landings_options[0].score <= -std::numeric_limits<double>::infinity() + 1.0)
     { // check against actual -INF
         // Evaluate staying put if it wasn't considered or had a bad score before
-        double stay_score = evaluate_move(gs, my_current_x, my_current_y, my_current_x, my_current_y, false, 0);
+        double stay_score = evaluate_move(gs, w, my_current_x, my_current_y, my_current_x, my_current_y, false, 0);
         // Check if current spot is actually valid to stay on
         if (gs.is_valid_for_move(my_current_x, my_current_y, false))
         {
@@ -743,40 +941,203 @@ MoveOption decide_move(GameState &gs)
     return valid_landings_options[0]; // The best option after sorting
 }
 
-// --- Main Execution ---
-int main()
+// The compiled-in evaluator, or the run-time one once --weights was given
+MoveOption decide_move(GameState &gs, const EvalWeights &weights)
 {
-    // Optional: For faster I/O in competitive programming, though less critical for file I/O
-    std::ios_base::sync_with_stdio(false);
-    std::cin.tie(NULL); // If reading from cin, not used here
+    if (weights.is_overridden())
+        return decide_move(gs, RuntimeWeights<>(weights));
+    return decide_move(gs, DefaultWeights());
+}
 
-    GameState gs;
-    gs.parse_input("MAP.INP"); // Reads from MAP.INP and loads STATE.DAT
+double evaluate_move(GameState &gs, const EvalWeights &weights, int next_x, int next_y, int current_x, int current_y, bool used_oil_slick_for_this_move,
+                     int steps_taken)
+{
+    if (weights.is_overridden())
+        return evaluate_move(gs, RuntimeWeights<>(weights), next_x, next_y, current_x, current_y, used_oil_slick_for_this_move, steps_taken);
+    return evaluate_move(gs, DefaultWeights(), next_x, next_y, current_x, current_y, used_oil_slick_for_this_move, steps_taken);
+}
 
-    int final_next_x = -1, final_next_y = -1;
-    bool decided_to_use_oil_this_turn = false;
+// --- Search Engines ---
 
-    if (gs.my_player.eliminated && gs.current_turn != 0)
+enum SearchEngine
+{
+    ENGINE_GREEDY,   // decide_move: one-ply scoring (default)
+    ENGINE_MCTS,     // decide_move_mcts
+    ENGINE_ALPHABETA // decide_move_alphabeta
+};
+
+// The simulator starts main.exe without arguments, so the default engine is
+// also selectable at build time with -DBOT_USE_MCTS or -DBOT_USE_ALPHABETA
+struct EngineOptions
+{
+#if defined(BOT_USE_MCTS)
+    SearchEngine engine = ENGINE_MCTS;
+#elif defined(BOT_USE_ALPHABETA)
+    SearchEngine engine = ENGINE_ALPHABETA;
+#else
+    SearchEngine engine = ENGINE_GREEDY;
+#endif
+    int time_limit_ms = 1400; // Whole turn, from process entry (or, in daemon mode, from when its input arrived)
+    int threads = 1;          // Search threads including the main one; 0 for one per hardware thread
+    EvalWeights weights = EvalWeights(WEIGHTS); // --weights=name=value,...
+};
+
+// What the engines keep from one turn to the next: the transposition table,
+// the MCTS node pools and the search threads. One per bot instance (see
+// bot_api.h), so two instances in one host never share a table.
+struct SearchEngines
+{
+    AlphaBetaSearch alphabeta;
+    ForwardModel model;
+    std::vector<std::unique_ptr<MctsSearch>> trees;
+    std::unique_ptr<ThreadPool> pool;
+};
+
+// The search threads, started on first use and kept until the engines go.
+// nullptr when searching single-threaded.
+ThreadPool *search_pool(SearchEngines &engines, const EngineOptions &options)
+{
+    if (options.threads == 1)
+        return nullptr;
+    if (!engines.pool)
+        engines.pool.reset(new ThreadPool(options.threads));
+    return engines.pool->size() > 1 ? engines.pool.get() : nullptr;
+}
+
+// Receives each move worth playing as soon as it is known, best last
+typedef std::function<void(const MoveOption &)> MoveSink;
+
+// Phrases a searched move like decide_move does, so the item bookkeeping in
+// play_turn stays the same
+MoveOption sim_move_option(const GameState &gs, const SimMove &move, double value)
+{
+    int steps = std::abs(move.x - gs.my_player.x) + std::abs(move.y - gs.my_player.y);
+    bool oil_used = gs.is_within_bounds(move.x, move.y) && gs.grid.at(move.x, move.y) == OBSTACLE_CELL;
+    return MoveOption(move.x, move.y, oil_used, steps, value);
+}
+
+// Searches with MCTS until the clock's search deadline, publishing the most
+// visited move as it goes. With a thread pool every thread grows its own tree
+// from its own seed (root parallelism) and the root visits are added up.
+// Opponents play as gs.opponents predicts them. Returns `fallback` if the
+// search could not finish a single iteration. `searched_nodes`, if set,
+// receives the iterations run.
+MoveOption decide_move_mcts(GameState &gs, SearchEngines &engines, const EngineOptions &options, TimeManager &clock, const MoveOption &fallback,
+                            const MoveSink &publish, long long *searched_nodes = nullptr)
+{
+    std::vector<std::unique_ptr<MctsSearch>> &trees = engines.trees; // Keep their node pools between turns
+    ThreadPool *pool = search_pool(engines, options);
+    int num_trees = pool ? pool->size() : 1;
+    while (int(trees.size()) < num_trees)
     {
-        final_next_x = 0; // Dummy valid output as per problem spec
-        final_next_y = 0;
+        trees.emplace_back(new MctsSearch());
+        trees.back()->set_seed(trees.back()->config.seed + 0x632BE59BD9B4E019ULL * trees.size());
     }
-    else if (gs.current_turn == 0)
+
+    SimState root = make_sim_state(gs);
+    int me = color_index(gs.my_player.color_char);
+    for (int k = 0; k < num_trees; ++k)
+        trees[k]->opponents = &gs.opponents;
+    if (publish)
+        trees[0]->on_progress = [&](const MctsResult &progress)
+        {
+            if (progress.found)
+                publish(sim_move_option(gs, progress.move, progress.value));
+        };
+    clock.begin_phase(PHASE_SEARCH);
+    SearchClock::time_point deadline = clock.search_deadline();
+    MctsResult results[64];
+    num_trees = std::min(num_trees, 64);
+    if (pool)
+        pool->run(num_trees, [&](int k, int) { results[k] = trees[k]->search(root, me, deadline); });
+    else
+        results[0] = trees[0]->search(root, me, deadline);
+    trees[0]->on_progress = nullptr;
+
+    SimMove moves[MAX_SIM_MOVES];
+    uint32_t visits[MAX_SIM_MOVES] = {};
+    double value_sum[MAX_SIM_MOVES] = {};
+    int n = 0, iterations = 0, tree_nodes = 0;
+    for (int k = 0; k < num_trees; ++k)
     {
-        std::pair<int, int> start_pos = choose_initial_position(gs);
-        final_next_x = start_pos.first;
-        final_next_y = start_pos.second;
-        // No oil slick can be used or active on turn 0 for placement
+        uint32_t tree_visits[MAX_SIM_MOVES];
+        double tree_values[MAX_SIM_MOVES];
+        n = trees[k]->root_stats(me, moves, tree_visits, tree_values);
+        for (int a = 0; a < n; ++a)
+        {
+            visits[a] += tree_visits[a];
+            value_sum[a] += tree_values[a];
+        }
+        iterations += results[k].iterations;
+        tree_nodes += trees[k]->tree_size();
     }
-    else
+    if (searched_nodes)
+        *searched_nodes = iterations;
+    int best = -1;
+    for (int a = 0; a < n; ++a)
     {
-        MoveOption best_move = decide_move(gs);
-        final_next_x = best_move.x;
-        final_next_y = best_move.y;
-        decided_to_use_oil_this_turn = best_move.oil_used;
+        if (visits[a] > 0 && (best < 0 || visits[a] > visits[best]))
+            best = a;
     }
+    if (best < 0)
+        return fallback;
+
+    double value = value_sum[best] / visits[best];
+    std::cerr << "mcts: " << iterations << " iterations, " << tree_nodes << " nodes in " << num_trees << " trees, move "
+              << moves[best].x << " " << moves[best].y << " visits " << visits[best] << " value " << value << std::endl;
+    return sim_move_option(gs, moves[best], value);
+}
 
-    // After deciding the move (final_next_x, final_next_y):
+// Same contract as decide_move_mcts; every finished depth is published. My
+// root moves are tried in the order evaluate_move ranks them; deeper levels
+// order themselves, opponents by gs.opponents where it predicts them.
+MoveOption decide_move_alphabeta(GameState &gs, SearchEngines &engines, const EngineOptions &options, TimeManager &clock, const MoveOption &fallback,
+                                 const MoveSink &publish, long long *searched_nodes = nullptr)
+{
+    AlphaBetaSearch &search = engines.alphabeta; // Keeps its transposition table between turns
+    ForwardModel &model = engines.model;
+
+    SimState root = make_sim_state(gs);
+    int me = color_index(gs.my_player.color_char);
+    if (me < 0 || me >= root.num_players)
+        return fallback;
+
+    SimMove moves[MAX_SIM_MOVES];
+    double scores[MAX_SIM_MOVES];
+    int n = model.safe_moves(root, me, moves);
+    for (int a = 0; a < n; ++a)
+    {
+        bool oil = gs.grid.at(moves[a].x, moves[a].y) == OBSTACLE_CELL;
+        int steps = std::abs(moves[a].x - gs.my_player.x) + std::abs(moves[a].y - gs.my_player.y);
+        double score = evaluate_move(gs, options.weights, moves[a].x, moves[a].y, gs.my_player.x, gs.my_player.y, oil, steps);
+        scores[a] = std::max(score, -1e6); // Keep -inf from swamping the other ordering keys
+    }
+
+    if (publish)
+        search.on_iteration = [&](const AlphaBetaResult &iteration)
+        {
+            publish(sim_move_option(gs, iteration.move, iteration.value));
+        };
+    search.opponents = &gs.opponents;
+    clock.begin_phase(PHASE_SEARCH);
+    AlphaBetaResult result = search.search(root, me, clock.search_deadline(), scores, search_pool(engines, options));
+    search.on_iteration = nullptr;
+    if (searched_nodes)
+        *searched_nodes = result.nodes;
+    if (!result.found)
+        return fallback;
+
+    double knps = result.seconds > 0 ? result.nodes / result.seconds / 1000.0 : 0.0;
+    std::cerr << "alphabeta: depth " << result.depth << ", " << result.nodes << " nodes, " << knps << " knodes/s, move "
+              << result.move.x << " " << result.move.y << " value " << result.value << std::endl;
+    return sim_move_option(gs, result.move, result.value);
+}
+
+// --- Turn Execution ---
+
+// Advances my item state past a turn in which I move to (next_x, next_y)
+void advance_my_item_state(GameState &gs, int final_next_x, int final_next_y, bool decided_to_use_oil_this_turn)
+{
     // 1. Check for item pickup at the destination IF player is not eliminated and moving to a valid spot
     if (!gs.my_player.eliminated && gs.is_within_bounds(final_next_x, final_next_y))
     {
@@ -794,20 +1155,464 @@ int main()
 
     // 2. Decrement active item durations. Pass whether oil was *activated* for the chosen move.
     gs.decrement_item_durations(decided_to_use_oil_this_turn);
+}
 
-    // 3. Save persistent item state for the *next* turn
-    gs.save_my_item_state();
+// What STATE.DAT should hold after playing `move`, leaving gs as it is
+std::string item_state_text_after(GameState &gs, const MoveOption &move)
+{
+    int boost = gs.speed_boost_turns_left, oil_turns = gs.oil_slick_turns_to_expire;
+    bool has_oil = gs.has_oil_slick, bomb = gs.paint_bomb_just_picked_up;
+    advance_my_item_state(gs, move.x, move.y, move.oil_used);
+    std::string text = gs.my_item_state_text();
+    gs.speed_boost_turns_left = boost;
+    gs.oil_slick_turns_to_expire = oil_turns;
+    gs.has_oil_slick = has_oil;
+    gs.paint_bomb_just_picked_up = bomb;
+    return text;
+}
 
-    std::ofstream move_out_file("MOVE.OUT");
-    if (move_out_file.is_open())
+// Decides the move for an already parsed turn and advances my item state to
+// what it will be at the start of the next turn. decide_move's answer is
+// handed to `publish` (if set) before any search starts, and the engines hand
+// it their improvements, so a usable move is out long before the deadline.
+std::pair<int, int> play_turn(GameState &gs, SearchEngines &engines, const EngineOptions &options, TimeManager &clock, const MoveSink &publish)
+{
+    int final_next_x = -1, final_next_y = -1;
+    bool decided_to_use_oil_this_turn = false;
+    clock.begin_phase(PHASE_PRECOMPUTE);
+    // Only the searches read the model, so one-ply play leaves STATE.DAT as it was
+    if (options.engine != ENGINE_GREEDY)
+        gs.opponents.observe(make_sim_state(gs), color_index(gs.my_player.color_char));
+
+    if (gs.my_player.eliminated && gs.current_turn != 0)
+    {
+        final_next_x = 0; // Dummy valid output as per problem spec
+        final_next_y = 0;
+    }
+    else if (gs.current_turn == 0)
+    {
+        std::pair<int, int> start_pos = choose_initial_position(gs);
+        final_next_x = start_pos.first;
+        final_next_y = start_pos.second;
+        // No oil slick can be used or active on turn 0 for placement
+    }
+    else
+    {
+        MoveOption fallback = decide_move(gs, options.weights);
+        if (publish)
+            publish(fallback);
+        MoveOption best_move = options.engine == ENGINE_MCTS        ? decide_move_mcts(gs, engines, options, clock, fallback, publish)
+                               : options.engine == ENGINE_ALPHABETA ? decide_move_alphabeta(gs, engines, options, clock, fallback, publish)
+                                                                    : fallback;
+        final_next_x = best_move.x;
+        final_next_y = best_move.y;
+        decided_to_use_oil_this_turn = best_move.oil_used;
+    }
+
+    advance_my_item_state(gs, final_next_x, final_next_y, decided_to_use_oil_this_turn);
+    clock.begin_phase(PHASE_OUTPUT);
+    return {final_next_x, final_next_y};
+}
+
+// --- Bot Instance ---
+
+// Applies one --engine / --time-ms / --threads / --weights argument; false
+// for anything else
+bool parse_engine_option(const std::string &arg, EngineOptions &options)
+{
+    std::string error;
+    if (arg == "--engine=mcts")
+        options.engine = ENGINE_MCTS;
+    else if (arg == "--engine=alphabeta")
+        options.engine = ENGINE_ALPHABETA;
+    else if (arg == "--engine=greedy")
+        options.engine = ENGINE_GREEDY;
+    else if (arg.compare(0, 10, "--time-ms=") == 0)
+        options.time_limit_ms = std::max(1, std::atoi(arg.c_str() + 10));
+    else if (arg.compare(0, 10, "--threads=") == 0)
+        options.threads = std::max(0, std::atoi(arg.c_str() + 10));
+    else if (arg.compare(0, 10, "--weights=") == 0)
     {
-        move_out_file << final_next_x << " " << final_next_y << std::endl;
-        move_out_file.close();
+        if (!options.weights.parse(arg.substr(10), &error))
+            std::cerr << "Warning: ignoring " << arg << ": " << error << std::endl;
     }
     else
+        return false;
+    return true;
+}
+
+// One player's bot: its options, the parsed turn with my item state, and the
+// engines. main.exe plays one turn on one, the daemon a whole process's worth
+// of games, and a host of the plugin ABI as many as it creates.
+struct BotInstance
+{
+    EngineOptions options;
+    std::string weights_text; // bot_weights()
+    GameState gs;
+    std::unique_ptr<SearchEngines> engines; // Behind a pointer: the searches' workers point back into them
+    int last_turn;                          // -1 before the first turn of a game
+
+    BotInstance() : engines(new SearchEngines()), last_turn(-1) {}
+
+    // Back to a fresh instance, keeping the options and the search threads
+    void reset()
+    {
+        std::unique_ptr<ThreadPool> pool = std::move(engines->pool);
+        gs = GameState();
+        engines.reset(new SearchEngines());
+        engines->pool = std::move(pool);
+        last_turn = -1;
+    }
+};
+
+// Parses the turn in MAP.INP text. A turn number that does not increase
+// starts a new game, which drops my item state.
+bool begin_turn(BotInstance &bot, const char *begin, const char *end)
+{
+    if (!bot.gs.parse_input_text(begin, end))
+        return false;
+    if (bot.gs.current_turn <= bot.last_turn)
+        bot.gs.reset_my_item_state();
+    bot.gs.paint_bomb_just_picked_up = false;
+    bot.last_turn = bot.gs.current_turn;
+    return true;
+}
+
+// Plays the turn in MAP.INP text. If it does not parse, the move is my last
+// known position and the result false.
+bool decide_turn(BotInstance &bot, const char *begin, const char *end, TimeManager &clock, const MoveSink &publish, std::pair<int, int> &move)
+{
+    if (!begin_turn(bot, begin, end))
+    {
+        move = {bot.gs.my_player.x, bot.gs.my_player.y};
+        return false;
+    }
+    move = play_turn(bot.gs, *bot.engines, bot.options, clock, publish);
+    return true;
+}
+
+// --- Daemon Mode ---
+//
+// `main.exe --daemon` serves a whole game from one process. The host writes
+// each turn to stdin in exactly the MAP.INP format and reads back one line
+// "x y" per turn on stdout. Item state stays in memory instead of STATE.DAT,
+// and so does everything built for earlier turns. A turn number that does not
+// increase starts a new game; EOF or a line "QUIT" ends the process. Positions
+// that come back on a later turn are reported on stderr.
+int run_daemon(const EngineOptions &options)
+{
+    BotInstance bot;
+    bot.options = options;
+    std::string block;
+    std::unordered_map<uint64_t, int> seen_positions; // position_hash() -> first turn
+
+    while (read_map_block(std::cin, block))
+    {
+        SearchClock::time_point turn_start = SearchClock::now(); // The host's clock starts about now
+        int previous_turn = bot.last_turn;
+        if (!begin_turn(bot, block.data(), block.data() + block.size()))
+        {
+            std::cout << bot.gs.my_player.x << " " << bot.gs.my_player.y << std::endl; // Keep the host in sync
+            continue;
+        }
+        if (bot.gs.current_turn <= previous_turn)
+            seen_positions.clear(); // New game on the same process
+
+        auto seen = seen_positions.emplace(bot.gs.position_hash(), bot.gs.current_turn);
+        if (!seen.second)
+            std::cerr << "daemon: turn " << bot.gs.current_turn << " repeats the position of turn " << seen.first->second << std::endl;
+
+        TimeManager clock(turn_start, options.time_limit_ms);
+        std::pair<int, int> move = play_turn(bot.gs, *bot.engines, options, clock, nullptr);
+        std::cout << move.first << " " << move.second << std::endl; // endl flushes the pipe
+        if (options.engine != ENGINE_GREEDY)
+            clock.report(std::cerr);
+    }
+    return 0;
+}
+
+// --- Plugin ABI ---
+//
+// See bot_api.h. Every call gets the --time-ms budget from its own entry.
+
+int bot_api_version(void)
+{
+    return BOT_API_VERSION;
+}
+
+BotInstance *bot_create(const char *options)
+{
+    BotInstance *bot = new BotInstance();
+    std::istringstream args(options ? options : "");
+    std::string arg;
+    while (args >> arg)
+    {
+        if (!parse_engine_option(arg, bot->options))
+            std::cerr << "Warning: ignoring unknown option " << arg << std::endl;
+    }
+    return bot;
+}
+
+int bot_init(BotInstance *bot, const char *map_text, size_t length)
+{
+    bot->reset();
+    // Builds the per-map tables now; last_turn stays -1, so any turn may come next
+    return bot->gs.parse_input_text(map_text, map_text + length) ? 0 : -1;
+}
+
+int bot_decide(BotInstance *bot, const char *map_text, size_t length, int *x, int *y)
+{
+    TimeManager clock(SearchClock::now(), bot->options.time_limit_ms);
+    std::pair<int, int> move;
+    bool parsed = decide_turn(*bot, map_text, map_text + length, clock, nullptr, move);
+    *x = move.first;
+    *y = move.second;
+    return parsed ? 0 : -1;
+}
+
+void bot_reset(BotInstance *bot)
+{
+    bot->reset();
+}
+
+void bot_destroy(BotInstance *bot)
+{
+    delete bot;
+}
+
+const char *bot_weights(BotInstance *bot)
+{
+    bot->weights_text = bot->options.weights.format();
+    return bot->weights_text.c_str();
+}
+
+#if defined(BOT_BENCH)
+
+// --- Benchmark Mode ---
+//
+// Built with -DBOT_BENCH, main.exe times this bot's functions over a corpus
+// from Simulator/pack_corpus.py: `main.exe corpus.txt [--passes=N] [--cold]`
+// plus the usual engine options. Every snapshot is parsed; those where I am
+// on the board past turn 0 also get evaluate_move on each safe landing,
+// find_path_to_nearest_item and decide_move, and with --engine=mcts or
+// alphabeta the search too, against a budget of --time-ms from its start.
+// ForwardModel::step is timed over random playouts from the same snapshots;
+// its nodes/s column is steps per second.
+// One BotInstance plays the whole corpus, as in daemon mode; --cold resets
+// it before every snapshot, as each turn under the simulator starts fresh.
+int run_bench(const std::string &corpus_file, const EngineOptions &options, int passes, bool cold)
+{
+    std::vector<BenchSnapshot> corpus;
+    std::string error;
+    if (!load_bench_corpus(corpus_file, corpus, &error))
+    {
+        std::cerr << "bench: " << error << std::endl;
+        return 1;
+    }
+
+    BenchStats parse_stats("parse_input"), evaluate_stats("evaluate_move"), path_stats("find_path_to_nearest_item"),
+        decide_stats("decide_move");
+    BenchStats search_stats(options.engine == ENGINE_MCTS ? "decide_move_mcts" : "decide_move_alphabeta");
+    BenchStats step_stats("ForwardModel::step");
+    const int STEP_PLAYOUTS = 16, STEP_PLAYOUT_TURNS = 40;
+    uint64_t step_rng = 0x9E3779B97F4A7C15ULL;
+    BotInstance bot;
+    bot.options = options;
+    GameState *gs = &bot.gs;
+    ForwardModel model;
+    std::streambuf *log = std::cerr.rdbuf(nullptr); // The engines report every search on stderr
+    int decided = 0;
+
+    for (int pass = 0; pass < passes; ++pass)
+    {
+        for (const BenchSnapshot &snapshot : corpus)
+        {
+            if (cold)
+                bot.reset();
+            bool parsed = false;
+            parse_stats.time([&]
+                             { parsed = gs->parse_input_text(snapshot.map.data(), snapshot.map.data() + snapshot.map.size()); });
+            if (!parsed)
+                continue;
+            gs->reset_my_item_state();
+            if (snapshot.has_state)
+            {
+                gs->speed_boost_turns_left = snapshot.speed_boost_turns_left;
+                gs->oil_slick_turns_to_expire = snapshot.oil_slick_turns_to_expire;
+                gs->has_oil_slick = snapshot.has_oil_slick == 1;
+            }
+            if (gs->current_turn == 0 || gs->my_player.eliminated || !gs->is_within_bounds(gs->my_player.x, gs->my_player.y))
+                continue;
+            ++decided;
+
+            SimState root = make_sim_state(*gs);
+            int me = color_index(gs->my_player.color_char);
+            if (me >= 0 && me < root.num_players)
+            {
+                SimMove moves[MAX_SIM_MOVES];
+                int n = model.safe_moves(root, me, moves);
+                for (int a = 0; a < n; ++a)
+                {
+                    bool oil = gs->grid.at(moves[a].x, moves[a].y) == OBSTACLE_CELL;
+                    int steps = std::abs(moves[a].x - gs->my_player.x) + std::abs(moves[a].y - gs->my_player.y);
+                    evaluate_stats.time([&] { evaluate_move(*gs, options.weights, moves[a].x, moves[a].y, gs->my_player.x, gs->my_player.y, oil, steps); });
+                }
+            }
+            path_stats.time([&] { find_path_to_nearest_item(*gs); });
+            long long steps = 0;
+            step_stats.time(
+                [&]
+                {
+                    for (int playout = 0; playout < STEP_PLAYOUTS; ++playout)
+                    {
+                        SimState s = root;
+                        for (int turn = 0; turn < STEP_PLAYOUT_TURNS && s.count_alive() > 0 && !s.is_game_over(); ++turn)
+                        {
+                            SimMove moves[MAX_SIM_PLAYERS];
+                            for (int i = 0; i < s.num_players; ++i)
+                            {
+                                SimMove options[MAX_SIM_MOVES];
+                                int n = model.legal_moves(s, i, options);
+                                step_rng ^= step_rng >> 12;
+                                step_rng ^= step_rng << 25;
+                                step_rng ^= step_rng >> 27;
+                                moves[i] = n > 0 ? options[(step_rng * 0x2545F4914F6CDD1DULL >> 32) % n] : SimMove{-1, -1};
+                            }
+                            model.step(s, moves);
+                            ++steps;
+                        }
+                    }
+                });
+            step_stats.add_nodes(steps);
+            MoveOption fallback;
+            decide_stats.time([&] { fallback = decide_move(*gs, options.weights); });
+
+            if (options.engine != ENGINE_GREEDY)
+            {
+                long long nodes = 0;
+                search_stats.time(
+                    [&]
+                    {
+                        TimeManager clock(SearchClock::now(), options.time_limit_ms);
+                        if (options.engine == ENGINE_MCTS)
+                            decide_move_mcts(*gs, *bot.engines, options, clock, fallback, nullptr, &nodes);
+                        else
+                            decide_move_alphabeta(*gs, *bot.engines, options, clock, fallback, nullptr, &nodes);
+                    });
+                search_stats.add_nodes(nodes);
+            }
+        }
+    }
+    std::cerr.rdbuf(log);
+
+    std::cout << corpus.size() << " snapshots, " << decided / std::max(passes, 1) << " to decide, " << passes << " pass(es)"
+              << (cold ? ", cold state" : "") << '\n';
+    BenchStats::print_header(std::cout);
+    parse_stats.print(std::cout);
+    evaluate_stats.print(std::cout);
+    path_stats.print(std::cout);
+    decide_stats.print(std::cout);
+    search_stats.print(std::cout);
+    step_stats.print(std::cout);
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    std::ios_base::sync_with_stdio(false);
+    std::string corpus_file;
+    EngineOptions options;
+    options.engine = ENGINE_GREEDY; // Searches only on request, whatever the build default
+    int passes = 1;
+    bool cold = false;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg.compare(0, 9, "--passes=") == 0)
+            passes = std::max(1, std::atoi(arg.c_str() + 9));
+        else if (arg == "--cold")
+            cold = true;
+        else if (arg.compare(0, 2, "--") != 0 && corpus_file.empty())
+            corpus_file = arg;
+        else if (!parse_engine_option(arg, options))
+            std::cerr << "Warning: ignoring unknown argument " << arg << std::endl;
+    }
+    if (corpus_file.empty())
+    {
+        std::cerr << "usage: " << argv[0] << " corpus.txt [--passes=N] [--cold] [--engine=...] [--time-ms=N] [--threads=N] [--weights=...]" << std::endl;
+        return 1;
+    }
+    return run_bench(corpus_file, options, passes, cold);
+}
+
+#elif !defined(BOT_LIBRARY)
+
+// --- Main Execution ---
+int main(int argc, char *argv[])
+{
+    // The simulator's 2 s timeout runs from process start; so does our budget
+    SearchClock::time_point process_start = SearchClock::now();
+
+    // Optional: For faster I/O in competitive programming, though less critical for file I/O
+    std::ios_base::sync_with_stdio(false);
+    std::cin.tie(NULL); // If reading from cin, not used here
+
+    bool daemon = false;
+    EngineOptions options;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg == "--daemon")
+            daemon = true;
+        else if (!parse_engine_option(arg, options))
+            std::cerr << "Warning: ignoring unknown argument " << arg << std::endl;
+    }
+
+    if (daemon)
+    {
+        return run_daemon(options);
+    }
+
+    TimeManager clock(process_start, options.time_limit_ms);
+    BotInstance bot;
+    bot.options = options;
+    GameState &gs = bot.gs;
+    std::string map_text;
+    if (!read_whole_file("MAP.INP", map_text))
+        std::cerr << "Error: Could not open MAP.INP" << std::endl;
+    gs.load_my_item_state(); // Parsing leaves the item state alone, so it can come first
+
+    // Every move handed over before the final one is written out right away,
+    // so a kill at the timeout leaves the latest of them. STATE.DAT goes first;
+    // only a kill between the two renames pairs the older move with the newer
+    // item state.
+    std::string published_move, published_state;
+    MoveSink publish = [&](const MoveOption &option)
+    {
+        std::string move_text = std::to_string(option.x) + " " + std::to_string(option.y) + "\n";
+        std::string state_text = item_state_text_after(gs, option);
+        if (move_text == published_move && state_text == published_state)
+            return;
+        if (state_text != published_state)
+            write_file_atomically("STATE.DAT", state_text);
+        write_file_atomically("MOVE.OUT", move_text);
+        published_move = move_text;
+        published_state = state_text;
+    };
+
+    std::pair<int, int> move;
+    decide_turn(bot, map_text.data(), map_text.data() + map_text.size(), clock, publish, move);
+    int final_next_x = move.first, final_next_y = move.second;
+
+    // Save persistent item state for the *next* turn
+    gs.save_my_item_state();
+
+    if (!write_file_atomically("MOVE.OUT", std::to_string(final_next_x) + " " + std::to_string(final_next_y) + "\n"))
     {
         std::cerr << "Error: Could not open MOVE.OUT for writing." << std::endl;
     }
+    if (options.engine != ENGINE_GREEDY)
+        clock.report(std::cerr);
 
     // Optional: Debugging output to stderr (remove or comment out for submission)
     /*
@@ -818,10 +1623,11 @@ int main()
     // for(const auto& item : gs.items_on_map) std::cerr << "  Item: " << item.r << " " << item.c << " " << item.type << std::endl;
     std::cerr << "SpeedBoostLeft: " << gs.speed_boost_turns_left
               << ", HasOilSlick: " << (gs.has_oil_slick ? "YES" : "NO")
-              << ", OilExpiresIn: " << gs.oil_slick_turns_to_expire
-              << ", OilUsedThisMove: " << (decided_to_use_oil_this_turn ? "YES" : "NO") << std::endl;
+              << ", OilExpiresIn: " << gs.oil_slick_turns_to_expire << std::endl;
     std::cerr << "PaintBombJustPickedUpFlag (after pickup check): " << (gs.paint_bomb_just_picked_up ? "YES" : "NO") << std::endl;
     */
 
     return 0;
-}
\ No newline at end of file
+}
+
+#endif
@@ -0,0 +1,15 @@
+#pragma once
+
+// Written by Source/opening_book; rebuild the bots after changing it.
+// Per map: opening_map_hash of its turn-0 board, the map file, and its best
+// starting cells (row, col), best first.
+const OpeningBookEntry OPENING_BOOK[] = {
+    {0x6e5112c2e5fb2a28ull, "A.txt", {{16, 7}, {13, 13}, {16, 4}, {13, 5}}},
+    {0x3ca7993022b01661ull, "B.txt", {{4, 7}, {4, 1}, {14, 11}, {7, 17}}},
+    {0x68dc00c27262fc04ull, "C.txt", {{17, 2}, {17, 5}, {14, 1}, {1, 2}}},
+    {0x745668795e435251ull, "D.txt", {{2, 2}, {20, 20}, {5, 2}, {13, 2}}},
+    {0xeb5110de27264a77ull, "E.txt", {{1, 14}, {15, 4}, {14, 1}, {14, 15}}},
+    {0x4891dbbf694c973bull, "F.txt", {{16, 16}, {16, 4}, {19, 13}, {14, 10}}},
+    {0x1b5d1ca99a5555dbull, "G.txt", {{15, 1}, {7, 16}, {1, 15}, {16, 13}}},
+    {0x917fa5c334d1453dull, "H.txt", {{4, 4}, {1, 1}, {4, 8}, {8, 8}}},
+};
@@ -0,0 +1,730 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "forward_model.h"
+#include "opponent_model.h"
+#include "search_common.h"
+#include "territory.h"
+#include "thread_pool.h"
+
+// --- Alpha-Beta Search ---
+//
+// Iterative-deepening search over the forward model. Depth is counted in whole
+// turns. Each turn is played out as a sequence of choices: the searching player
+// moves first, then every other live player in colour order, and the turn is
+// applied once all moves are chosen. Later choosers see the earlier moves, which
+// is the paranoid reading of simultaneous moves.
+//   - Two live players: paranoid alpha-beta on (my value - opponent's value).
+//   - Three or four: max-n, where each player maximises its own entry of the
+//     value vector. Max-n allows no deep cutoffs, so it gets fewer turns deep.
+// Turn-level positions go into a Zobrist-keyed transposition table. Moves are
+// ordered by the table's best move, then killers, history and score_move (or
+// the caller's scores at the root). The search walks one SimState with
+// make_move / unmake_move, so a node costs no copy and no allocation.
+//
+// Given an OpponentModel, opponents try their predicted moves first, and where
+// the model is confident they search only those. The table key leaves out the
+// previous turn the predictions read, so an entry may hold a value searched
+// with other predictions; like any other table hit, that is taken as close enough.
+//
+// Given a ThreadPool, each iteration splits my root moves across its threads.
+// Every thread has its own worker (state, forward model, killers, history) and
+// all of them share one lock-free table. In paranoid mode the best-ordered
+// move is searched first, alone, so the others start with its value as alpha.
+
+struct AlphaBetaConfig
+{
+    int max_depth = 64;          // Turns
+    int table_bits = 18;         // 2^18 entries of 32 bytes
+    double survival_bonus = 50.0; // Worth of being alive, in cells
+    // Per cell of Territory::gain at a leaf. Off: leaves valued with it lost
+    // to area-only leaves in self-play at 0.05 and 0.25, which trade painting
+    // now for room to paint later.
+    double territory_weight = 0.0;
+    int check_every = 256;       // Nodes between deadline checks
+    double prior_cutoff = 0.05;  // Opponent moves a confident prediction gives less are not searched
+    double prior_order = 100.0;  // score_move points per unit of predicted probability, for ordering
+};
+
+struct AlphaBetaResult
+{
+    bool found;     // false if not even depth 1 finished in time
+    SimMove move;
+    int depth;      // Deepest completed iteration
+    long long nodes; // Summed over threads
+    double seconds;
+    double value;   // From the searching player's point of view
+};
+
+enum AlphaBetaBound : uint8_t
+{
+    BOUND_NONE = 0,
+    BOUND_EXACT,
+    BOUND_LOWER,
+    BOUND_UPPER
+};
+
+// Transposition table shared by all search threads without locks. A slot is a
+// check word and three data words, each written and read atomically but not
+// together; the check word is the key XOR the data, so a slot torn by two
+// concurrent stores reads back as a miss instead of as wrong data.
+class AlphaBetaTable
+{
+public:
+    struct Entry
+    {
+        float values[MAX_SIM_PLAYERS]; // Paranoid uses values[0]
+        int8_t depth;
+        uint8_t bound;      // AlphaBetaBound
+        int8_t best;        // My move index in safe_moves order
+        uint8_t generation;
+    };
+
+    void resize(int bits)
+    {
+        size_t size = size_t(1) << bits;
+        if (size == mask + 1 && slots)
+            return;
+        slots.reset(new Slot[size]()); // Value-initialised: all zero, so every slot misses
+        mask = size - 1;
+    }
+
+    void new_search() { ++generation; }
+
+    bool probe(uint64_t key, Entry &out) const
+    {
+        const Slot &slot = slots[key & mask];
+        uint64_t data[3];
+        for (int w = 0; w < 3; ++w)
+            data[w] = slot.data[w].load(std::memory_order_relaxed);
+        if ((slot.check.load(std::memory_order_relaxed) ^ data[0] ^ data[1] ^ data[2]) != key)
+            return false;
+        unpack(data, out);
+        return out.bound != BOUND_NONE;
+    }
+
+    void store(uint64_t key, int depth, uint8_t bound, const double *values, int num_values, int best)
+    {
+        Slot &slot = slots[key & mask];
+        uint64_t old[3];
+        for (int w = 0; w < 3; ++w)
+            old[w] = slot.data[w].load(std::memory_order_relaxed);
+        uint64_t old_key = slot.check.load(std::memory_order_relaxed) ^ old[0] ^ old[1] ^ old[2];
+        Entry current;
+        unpack(old, current);
+        // Replace older searches' entries and shallower ones of this search
+        if (old_key != key && current.bound != BOUND_NONE && current.generation == generation && current.depth > depth)
+            return;
+
+        Entry entry = {{0, 0, 0, 0}, int8_t(std::min(depth, 127)), bound, int8_t(best), generation};
+        for (int i = 0; i < num_values; ++i)
+            entry.values[i] = float(values[i]);
+        uint64_t data[3];
+        pack(entry, data);
+        for (int w = 0; w < 3; ++w)
+            slot.data[w].store(data[w], std::memory_order_relaxed);
+        slot.check.store(key ^ data[0] ^ data[1] ^ data[2], std::memory_order_relaxed);
+    }
+
+private:
+    struct Slot
+    {
+        std::atomic<uint64_t> check;
+        std::atomic<uint64_t> data[3];
+    };
+
+    std::unique_ptr<Slot[]> slots;
+    size_t mask = 0;
+    uint8_t generation = 0;
+
+    static void pack(const Entry &entry, uint64_t *data)
+    {
+        std::memcpy(&data[0], &entry.values[0], 8);
+        std::memcpy(&data[1], &entry.values[2], 8);
+        data[2] = uint64_t(uint8_t(entry.depth)) | uint64_t(entry.bound) << 8 | uint64_t(uint8_t(entry.best)) << 16 |
+                  uint64_t(entry.generation) << 24;
+    }
+
+    static void unpack(const uint64_t *data, Entry &entry)
+    {
+        std::memcpy(&entry.values[0], &data[0], 8);
+        std::memcpy(&entry.values[2], &data[1], 8);
+        entry.depth = int8_t(data[2] & 0xFF);
+        entry.bound = uint8_t(data[2] >> 8);
+        entry.best = int8_t(data[2] >> 16);
+        entry.generation = uint8_t(data[2] >> 24);
+    }
+};
+
+class AlphaBetaSearch
+{
+public:
+    static const int MAX_PLY = 256; // Player choices along one line
+
+    AlphaBetaConfig config;
+    MoveWeights weights;
+    const OpponentModel *opponents = nullptr; // Optional; see opponent_model.h
+    // Called after every completed iteration with its result, e.g. to publish
+    // the move before the deadline
+    std::function<void(const AlphaBetaResult &)> on_iteration;
+
+    AlphaBetaSearch() {}
+
+    // `root_scores`, if given, ranks my moves in ForwardModel::safe_moves
+    // order for the first iteration (e.g. evaluate_move's scores). With a
+    // `pool` the root moves of each iteration are searched in parallel.
+    AlphaBetaResult search(const SimState &root, int me, SearchClock::time_point deadline, const double *root_scores = nullptr,
+                           ThreadPool *pool = nullptr)
+    {
+        SearchClock::time_point start = SearchClock::now();
+        AlphaBetaResult result = {false, {-1, -1}, 0, 0, 0.0, 0.0};
+        if (me < 0 || me >= root.num_players || !root.players[me].alive)
+            return result;
+
+        table.resize(config.table_bits);
+        table.new_search();
+        int num_workers = pool ? pool->size() : 1;
+        while (int(workers.size()) < num_workers)
+            workers.emplace_back(new Worker(this));
+        for (int w = 0; w < num_workers; ++w)
+            workers[w]->begin_search(root, me, deadline, opponents);
+
+        Worker &main = *workers[0];
+        SimMove root_moves[MAX_SIM_MOVES];
+        int num_root = main.model.safe_moves(root, me, root_moves);
+        double root_rank[MAX_SIM_MOVES];
+        const SealSchedule &seals = main.model.seal_schedule(root);
+        for (int a = 0; a < num_root; ++a)
+            root_rank[a] = root_scores ? root_scores[a] : score_move(root, me, root_moves[a], weights, seals);
+
+        for (int depth = 1; depth <= config.max_depth; ++depth)
+        {
+            for (int w = 0; w < num_workers; ++w)
+                workers[w]->hit_horizon = false;
+
+            AlphaBetaTable::Entry entry;
+            int perm[MAX_SIM_MOVES];
+            main.order_moves(root, me, 0, root_moves, num_root, table.probe(root.hash, entry) ? entry.best : -1, root_rank, perm);
+
+            int best = main.paranoid ? root_paranoid(depth, root_moves, num_root, perm, pool)
+                                     : root_max_n(depth, root_moves, num_root, perm, pool);
+            bool aborted = false, hit_horizon = false;
+            long long nodes = 0;
+            for (int w = 0; w < num_workers; ++w)
+            {
+                aborted |= workers[w]->aborted;
+                hit_horizon |= workers[w]->hit_horizon;
+                nodes += workers[w]->nodes;
+            }
+            result.nodes = nodes;
+            if (aborted || best < 0)
+                break;
+
+            // Paranoid fills only slot 0 of a root value, max-n one per player
+            int num_values = main.paranoid ? 1 : root.num_players;
+            double values[MAX_SIM_PLAYERS] = {};
+            for (int i = 0; i < num_values; ++i)
+                values[i] = root_values[best][i];
+            table.store(root.hash, depth, BOUND_EXACT, values, num_values, best);
+
+            result.found = true;
+            result.move = root_moves[best];
+            result.depth = depth;
+            result.value = main.paranoid ? values[0] : values[me];
+            if (on_iteration)
+            {
+                result.seconds = std::chrono::duration<double>(SearchClock::now() - start).count();
+                on_iteration(result);
+            }
+            // Nothing left to search once the whole game fits in the horizon
+            if (!hit_horizon)
+                break;
+        }
+
+        result.seconds = std::chrono::duration<double>(SearchClock::now() - start).count();
+        return result;
+    }
+
+private:
+    class Worker;
+
+    AlphaBetaTable table;
+    std::vector<std::unique_ptr<Worker>> workers;
+    double root_values[MAX_SIM_MOVES][MAX_SIM_PLAYERS];
+
+    // Runs task(k, worker) for k in [0, n), on the pool if there is one
+    static void run_tasks(ThreadPool *pool, int n, const ThreadPool::Task &task)
+    {
+        if (pool)
+            pool->run(n, task);
+        else
+            for (int k = 0; k < n; ++k)
+                task(k, 0);
+    }
+
+    // Searches perm[0] with a full window, then the rest in parallel with the
+    // best value so far as alpha. A move whose value does not beat the alpha
+    // it was searched with is only bounded from above, so only moves that
+    // did beat it are candidates. Returns the best index, or -1 if aborted.
+    int root_paranoid(int depth, const SimMove *moves, int n, const int *perm, ThreadPool *pool)
+    {
+        bool exact[MAX_SIM_MOVES] = {};
+        root_values[perm[0]][0] = workers[0]->paranoid_root_child(moves[perm[0]], depth, -1e18);
+        if (workers[0]->aborted)
+            return -1;
+        exact[perm[0]] = true;
+
+        std::atomic<double> alpha(root_values[perm[0]][0]);
+        run_tasks(pool, n - 1, [&](int k, int w)
+        {
+            int a = perm[k + 1];
+            double window = alpha.load();
+            double value = workers[w]->paranoid_root_child(moves[a], depth, window);
+            root_values[a][0] = value;
+            exact[a] = value > window;
+            double seen = alpha.load();
+            while (value > seen && !alpha.compare_exchange_weak(seen, value))
+            {
+            }
+        });
+
+        int best = -1;
+        for (int k = 0; k < n; ++k)
+        {
+            int a = perm[k];
+            if (exact[a] && (best < 0 || root_values[a][0] > root_values[best][0]))
+                best = a;
+        }
+        return best;
+    }
+
+    int root_max_n(int depth, const SimMove *moves, int n, const int *perm, ThreadPool *pool)
+    {
+        int me = workers[0]->me;
+        run_tasks(pool, n, [&](int k, int w)
+        {
+            int a = perm[k];
+            workers[w]->max_n_root_child(moves[a], depth, root_values[a]);
+        });
+        int best = -1;
+        for (int k = 0; k < n; ++k)
+        {
+            int a = perm[k];
+            if (best < 0 || root_values[a][me] > root_values[best][me])
+                best = a;
+        }
+        return best;
+    }
+
+    // One search thread's state. Nothing in here is shared except the table.
+    class Worker
+    {
+    public:
+        ForwardModel model;
+        SimState state; // The root, walked with make/unmake
+        int me = 0;
+        bool paranoid = true;
+        bool aborted = false;
+        bool hit_horizon = false; // Some line of this iteration stopped short of the game's end
+        long long nodes = 0;
+
+        explicit Worker(AlphaBetaSearch *owner) : table(&owner->table), config(&owner->config), weights(&owner->weights) {}
+
+        void begin_search(const SimState &root, int me, SearchClock::time_point deadline, const OpponentModel *opponents)
+        {
+            state = root;
+            this->me = me;
+            this->deadline = deadline;
+            this->opponents = opponents;
+            for (int i = 0; i < MAX_SIM_PLAYERS; ++i)
+                previous[i] = opponents ? opponents->previous_position(i) : -1;
+            aborted = false;
+            nodes = 0;
+            for (auto &row : history)
+                std::fill(std::begin(row), std::end(row), 0);
+            for (auto &slots : killers)
+                slots[0] = slots[1] = -1;
+
+            num_order = 0;
+            order[num_order++] = me;
+            for (int i = 0; i < root.num_players; ++i)
+            {
+                if (i != me && root.players[i].alive)
+                    order[num_order++] = i;
+            }
+            paranoid = (num_order <= 2);
+        }
+
+        // My value after playing `mine` at the root, searched with window (alpha, inf)
+        double paranoid_root_child(const SimMove &mine, int depth, double alpha)
+        {
+            SimMove chosen[MAX_SIM_PLAYERS];
+            chosen[me] = mine;
+            return paranoid_choice(state, depth, 1, chosen, alpha, 1e18, 1);
+        }
+
+        void max_n_root_child(const SimMove &mine, int depth, double *values)
+        {
+            SimMove chosen[MAX_SIM_PLAYERS];
+            chosen[me] = mine;
+            max_n_choice(state, depth, 1, chosen, values, 1);
+        }
+
+        // Orders moves[0..n) for `player` at choice `ply`: table move, killers,
+        // history, then the heuristic (or `rank` when given)
+        void order_moves(const SimState &s, int player, int ply, const SimMove *moves, int n, int table_best, const double *rank, int *perm)
+        {
+            const SealSchedule &seals = model.seal_schedule(s);
+            double key[MAX_SIM_MOVES];
+            for (int a = 0; a < n; ++a)
+            {
+                int target = s.grid.idx(moves[a].x, moves[a].y);
+                double k = rank ? rank[a] : score_move(s, player, moves[a], *weights, seals);
+                k += history[player][target] * 1e-3;
+                if (ply < MAX_PLY && (killers[ply][0] == target || killers[ply][1] == target))
+                    k += 1e6;
+                if (a == table_best)
+                    k += 1e9;
+                key[a] = k;
+                perm[a] = a;
+            }
+            // Insertion sort: at most MAX_SIM_MOVES entries
+            for (int i = 1; i < n; ++i)
+            {
+                int a = perm[i], j = i;
+                for (; j > 0 && key[perm[j - 1]] < key[a]; --j)
+                    perm[j] = perm[j - 1];
+                perm[j] = a;
+            }
+        }
+
+    private:
+        AlphaBetaTable *table;
+        const AlphaBetaConfig *config;
+        const MoveWeights *weights;
+        const OpponentModel *opponents = nullptr;
+        int previous[MAX_SIM_PLAYERS]; // Everyone's position a turn before the current one
+        SearchClock::time_point deadline;
+        int order[MAX_SIM_PLAYERS];
+        int num_order = 0;
+        int killers[MAX_PLY][2];
+        int history[MAX_SIM_PLAYERS][MAX_PADDED_CELLS];
+        Territory territory; // Leaf evaluation scratch
+
+        bool out_of_time()
+        {
+            if (aborted)
+                return true;
+            if (++nodes % config->check_every == 0 && SearchClock::now() >= deadline)
+                aborted = true;
+            return aborted;
+        }
+
+        // Area, a bonus for being alive and a share of the cells each player
+        // would get to paint first, in cells
+        void evaluate(const SimState &s, double *values)
+        {
+            if (config->territory_weight != 0.0)
+            {
+                TerritorySource sources[MAX_SIM_PLAYERS];
+                for (int i = 0; i < s.num_players; ++i)
+                {
+                    const SimPlayer &p = s.players[i];
+                    bool boosted = p.powerup == POWERUP_SPEED_BOOST;
+                    sources[i] = {p.alive ? p.pos : -1, boosted ? int(p.boost_turns) : 0, p.color};
+                }
+                const FlatGrid &g = s.grid;
+                territory.compute(g, sources, s.num_players, [&](int idx) { return is_blocked_cell(g[idx]); });
+            }
+            for (int i = 0; i < s.num_players; ++i)
+            {
+                values[i] = s.area_of(i) + (s.players[i].alive ? config->survival_bonus : 0.0);
+                if (config->territory_weight != 0.0)
+                    values[i] += config->territory_weight * territory.gain[i];
+            }
+        }
+
+        double paranoid_value(const SimState &s)
+        {
+            double values[MAX_SIM_PLAYERS];
+            evaluate(s, values);
+            double opponent = 0.0;
+            for (int k = 1; k < num_order; ++k)
+                opponent = std::max(opponent, values[order[k]]);
+            return values[me] - opponent;
+        }
+
+        bool is_leaf(const SimState &s, int depth)
+        {
+            if (!s.players[me].alive || s.is_game_over())
+                return true;
+            if (depth <= 0)
+            {
+                hit_horizon = true;
+                return true;
+            }
+            return false;
+        }
+
+        void reward_cutoff(const SimState &s, int player, int ply, const SimMove &move, int depth)
+        {
+            int target = s.grid.idx(move.x, move.y);
+            history[player][target] += depth * depth;
+            if (ply < MAX_PLY && killers[ply][0] != target)
+            {
+                killers[ply][1] = killers[ply][0];
+                killers[ply][0] = target;
+            }
+        }
+
+        // safe_moves of opponent `player` and their order in perm; returns how
+        // many to search. Predicted moves go first, and only they are kept
+        // when the model is confident.
+        int opponent_moves(const SimState &s, int player, int ply, SimMove *moves, int *perm)
+        {
+            int n = model.safe_moves(s, player, moves);
+            double probs[MAX_SIM_MOVES];
+            bool confident = false;
+            if (n == 0 || !opponents || !opponents->predict(s, player, previous[player], moves, n, probs, &confident))
+            {
+                order_moves(s, player, ply, moves, n, -1, nullptr, perm);
+                return n;
+            }
+            if (confident)
+                n = keep_likely_moves(moves, probs, n, config->prior_cutoff);
+            const SealSchedule &seals = model.seal_schedule(s);
+            double rank[MAX_SIM_MOVES];
+            for (int a = 0; a < n; ++a)
+                rank[a] = score_move(s, player, moves[a], *weights, seals) + config->prior_order * probs[a];
+            order_moves(s, player, ply, moves, n, -1, rank, perm);
+            return n;
+        }
+
+        // Plays the chosen moves of a turn, keeping `previous` in step
+        void make_turn(SimState &s, const SimMove *chosen, int *saved)
+        {
+            SimMove moves[MAX_SIM_PLAYERS];
+            for (int i = 0; i < s.num_players; ++i)
+                moves[i] = SimMove{-1, -1};
+            for (int j = 0; j < num_order; ++j)
+                moves[order[j]] = chosen[order[j]];
+            for (int i = 0; i < MAX_SIM_PLAYERS; ++i)
+            {
+                saved[i] = previous[i];
+                previous[i] = i < s.num_players ? s.players[i].pos : -1;
+            }
+            model.make_move(s, moves);
+        }
+
+        void unmake_turn(SimState &s, const int *saved)
+        {
+            model.unmake_move(s);
+            std::copy(saved, saved + MAX_SIM_PLAYERS, previous);
+        }
+
+        // --- Paranoid ---
+
+        // Value of a turn-level position for me
+        double paranoid_turn(SimState &s, int depth, double alpha, double beta, int ply)
+        {
+            if (out_of_time())
+                return 0.0;
+            if (is_leaf(s, depth))
+                return paranoid_value(s);
+
+            uint64_t key = s.hash;
+            AlphaBetaTable::Entry entry;
+            int table_best = -1;
+            if (table->probe(key, entry))
+            {
+                table_best = entry.best;
+                if (entry.depth >= depth)
+                {
+                    double v = entry.values[0];
+                    if (entry.bound == BOUND_EXACT || (entry.bound == BOUND_LOWER && v >= beta) || (entry.bound == BOUND_UPPER && v <= alpha))
+                    {
+                        hit_horizon = true; // Unknown whether that line reached the end
+                        return v;
+                    }
+                }
+            }
+
+            SimMove moves[MAX_SIM_MOVES];
+            int n = model.safe_moves(s, me, moves);
+            int perm[MAX_SIM_MOVES];
+            order_moves(s, me, ply, moves, n, table_best, nullptr, perm);
+
+            double alpha_start = alpha;
+            double best_value = -1e18;
+            int best = -1;
+            SimMove chosen[MAX_SIM_PLAYERS];
+            for (int k = 0; k < n; ++k)
+            {
+                int a = perm[k];
+                chosen[me] = moves[a];
+                double value = paranoid_choice(s, depth, 1, chosen, alpha, beta, ply + 1);
+                if (aborted)
+                    return 0.0;
+                if (value > best_value)
+                {
+                    best_value = value;
+                    best = a;
+                }
+                alpha = std::max(alpha, value);
+                if (alpha >= beta)
+                {
+                    reward_cutoff(s, me, ply, moves[a], depth);
+                    break;
+                }
+            }
+
+            uint8_t bound = best_value <= alpha_start ? BOUND_UPPER : best_value >= beta ? BOUND_LOWER : BOUND_EXACT;
+            double values[1] = {best_value};
+            table->store(key, depth, bound, values, 1, best);
+            return best_value;
+        }
+
+        // Opponents (order[k], k >= 1) choose after seeing my move and minimise
+        double paranoid_choice(SimState &s, int depth, int k, SimMove *chosen, double alpha, double beta, int ply)
+        {
+            if (k == num_order)
+            {
+                int saved[MAX_SIM_PLAYERS];
+                make_turn(s, chosen, saved);
+                double value = paranoid_turn(s, depth - 1, alpha, beta, ply);
+                unmake_turn(s, saved);
+                return value;
+            }
+
+            int player = order[k];
+            SimMove moves[MAX_SIM_MOVES];
+            int perm[MAX_SIM_MOVES];
+            int n = opponent_moves(s, player, ply, moves, perm);
+            if (n == 0)
+            {
+                chosen[player] = SimMove{-1, -1};
+                return paranoid_choice(s, depth, k + 1, chosen, alpha, beta, ply + 1);
+            }
+
+            double best_value = 1e18;
+            for (int j = 0; j < n; ++j)
+            {
+                int a = perm[j];
+                chosen[player] = moves[a];
+                double value = paranoid_choice(s, depth, k + 1, chosen, alpha, beta, ply + 1);
+                if (aborted)
+                    return 0.0;
+                best_value = std::min(best_value, value);
+                beta = std::min(beta, value);
+                if (alpha >= beta)
+                {
+                    reward_cutoff(s, player, ply, moves[a], depth);
+                    break;
+                }
+            }
+            return best_value;
+        }
+
+        // --- Max-n ---
+
+        void max_n_turn(SimState &s, int depth, double *values, int ply)
+        {
+            if (out_of_time())
+                return;
+            if (is_leaf(s, depth))
+            {
+                evaluate(s, values);
+                return;
+            }
+
+            uint64_t key = s.hash;
+            AlphaBetaTable::Entry entry;
+            int table_best = -1;
+            if (table->probe(key, entry))
+            {
+                table_best = entry.best;
+                if (entry.depth >= depth && entry.bound == BOUND_EXACT)
+                {
+                    hit_horizon = true;
+                    for (int i = 0; i < s.num_players; ++i)
+                        values[i] = entry.values[i];
+                    return;
+                }
+            }
+
+            SimMove moves[MAX_SIM_MOVES];
+            int n = model.safe_moves(s, me, moves);
+            int perm[MAX_SIM_MOVES];
+            order_moves(s, me, ply, moves, n, table_best, nullptr, perm);
+
+            int best = -1;
+            SimMove chosen[MAX_SIM_PLAYERS];
+            double child[MAX_SIM_PLAYERS];
+            for (int k = 0; k < n; ++k)
+            {
+                int a = perm[k];
+                chosen[me] = moves[a];
+                max_n_choice(s, depth, 1, chosen, child, ply + 1);
+                if (aborted)
+                    return;
+                if (best < 0 || child[me] > values[me])
+                {
+                    best = a;
+                    std::copy(child, child + s.num_players, values);
+                }
+            }
+            if (best >= 0)
+            {
+                history[me][s.grid.idx(moves[best].x, moves[best].y)] += depth * depth;
+                table->store(key, depth, BOUND_EXACT, values, s.num_players, best);
+            }
+        }
+
+        void max_n_choice(SimState &s, int depth, int k, SimMove *chosen, double *values, int ply)
+        {
+            if (k == num_order)
+            {
+                int saved[MAX_SIM_PLAYERS];
+                make_turn(s, chosen, saved);
+                max_n_turn(s, depth - 1, values, ply);
+                unmake_turn(s, saved);
+                return;
+            }
+
+            int player = order[k];
+            SimMove moves[MAX_SIM_MOVES];
+            int perm[MAX_SIM_MOVES];
+            int n = opponent_moves(s, player, ply, moves, perm);
+            if (n == 0)
+            {
+                chosen[player] = SimMove{-1, -1};
+                max_n_choice(s, depth, k + 1, chosen, values, ply + 1);
+                return;
+            }
+
+            int best = -1;
+            double child[MAX_SIM_PLAYERS];
+            for (int j = 0; j < n; ++j)
+            {
+                int a = perm[j];
+                chosen[player] = moves[a];
+                max_n_choice(s, depth, k + 1, chosen, child, ply + 1);
+                if (aborted)
+                    return;
+                if (best < 0 || child[player] > values[player])
+                {
+                    best = a;
+                    std::copy(child, child + s.num_players, values);
+                }
+            }
+            history[player][s.grid.idx(moves[best].x, moves[best].y)] += depth * depth;
+        }
+    };
+};
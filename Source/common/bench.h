@@ -0,0 +1,297 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <new>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "map_parser.h"
+
+// --- Benchmark Harness ---
+//
+// Shared by the bots' -DBOT_BENCH builds, which replay a corpus of recorded
+// turns through their own functions and time every call. A corpus is made by
+// Simulator/pack_corpus.py from the Match folder: one record per player and
+// turn, each a line "SNAPSHOT <label>", the turn exactly as MAP.INP held it
+// and, when known, a line "STATE <speed boost> <oil turns> <has oil>" with the
+// STATE.DAT the bot read on that turn.
+//
+// This header replaces the global operator new and delete so allocations can
+// be counted; include it from the one translation unit of a bench build only.
+
+struct BenchSnapshot
+{
+    std::string label;
+    std::string map; // MAP.INP text
+    bool has_state;  // false: the bot starts the turn holding nothing
+    int speed_boost_turns_left;
+    int oil_slick_turns_to_expire;
+    int has_oil_slick;
+};
+
+inline bool load_bench_corpus(const std::string &filename, std::vector<BenchSnapshot> &corpus, std::string *error = nullptr)
+{
+    std::ifstream in(filename);
+    if (!in.is_open())
+    {
+        if (error)
+            *error = "cannot open " + filename;
+        return false;
+    }
+    corpus.clear();
+    std::string line;
+    bool pending = false; // `line` already holds the next record's header
+    while (pending || std::getline(in, line))
+    {
+        pending = false;
+        if (line.find_first_not_of(" \t\r") == std::string::npos)
+            continue;
+        if (line.compare(0, 9, "SNAPSHOT ") != 0)
+        {
+            if (error)
+                *error = "expected SNAPSHOT, got: " + line;
+            return false;
+        }
+        BenchSnapshot snapshot = {line.substr(9), std::string(), false, 0, 0, 0};
+        while (!snapshot.label.empty() && (snapshot.label.back() == '\r' || snapshot.label.back() == ' '))
+            snapshot.label.pop_back();
+        if (!read_map_block(in, snapshot.map))
+        {
+            if (error)
+                *error = "missing map for " + snapshot.label;
+            return false;
+        }
+        while (std::getline(in, line))
+        {
+            if (line.find_first_not_of(" \t\r") == std::string::npos)
+                continue;
+            if (line.compare(0, 6, "STATE ") == 0)
+            {
+                std::istringstream(line.substr(6)) >> snapshot.speed_boost_turns_left >> snapshot.oil_slick_turns_to_expire >>
+                    snapshot.has_oil_slick;
+                snapshot.has_state = true;
+            }
+            else
+            {
+                pending = true;
+            }
+            break;
+        }
+        corpus.push_back(snapshot);
+    }
+    return true;
+}
+
+// --- Allocation Counting ---
+
+struct BenchAllocations
+{
+    long long count;
+    long long bytes;
+};
+
+inline std::atomic<long long> &bench_allocation_count()
+{
+    static std::atomic<long long> count(0);
+    return count;
+}
+
+inline std::atomic<long long> &bench_allocation_bytes()
+{
+    static std::atomic<long long> bytes(0);
+    return bytes;
+}
+
+inline BenchAllocations bench_allocations()
+{
+    return BenchAllocations{bench_allocation_count().load(std::memory_order_relaxed),
+                            bench_allocation_bytes().load(std::memory_order_relaxed)};
+}
+
+// Every replaced allocation and release goes through these two, so each
+// operator new is paired with an operator delete over the same allocator.
+// They stay out of line: once inlined, g++ would see std::free meet a
+// pointer from operator new and warn (-Wmismatched-new-delete).
+__attribute__((noinline)) inline void *bench_allocate(std::size_t size, std::size_t alignment = 0) noexcept
+{
+    bench_allocation_count().fetch_add(1, std::memory_order_relaxed);
+    bench_allocation_bytes().fetch_add((long long)size, std::memory_order_relaxed);
+    if (size == 0)
+        size = 1;
+    if (alignment <= alignof(std::max_align_t))
+        return std::malloc(size);
+    // aligned_alloc wants a size that is a multiple of the alignment
+    return std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+}
+
+__attribute__((noinline)) inline void bench_release(void *p) noexcept
+{
+    std::free(p);
+}
+
+__attribute__((noinline)) void *operator new(std::size_t size)
+{
+    if (void *p = bench_allocate(size))
+        return p;
+    throw std::bad_alloc();
+}
+
+__attribute__((noinline)) void *operator new[](std::size_t size)
+{
+    if (void *p = bench_allocate(size))
+        return p;
+    throw std::bad_alloc();
+}
+
+__attribute__((noinline)) void *operator new(std::size_t size, std::align_val_t alignment)
+{
+    if (void *p = bench_allocate(size, std::size_t(alignment)))
+        return p;
+    throw std::bad_alloc();
+}
+
+__attribute__((noinline)) void *operator new[](std::size_t size, std::align_val_t alignment)
+{
+    if (void *p = bench_allocate(size, std::size_t(alignment)))
+        return p;
+    throw std::bad_alloc();
+}
+
+__attribute__((noinline)) void *operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+    return bench_allocate(size);
+}
+
+__attribute__((noinline)) void *operator new[](std::size_t size, const std::nothrow_t &) noexcept
+{
+    return bench_allocate(size);
+}
+
+__attribute__((noinline)) void operator delete(void *p) noexcept
+{
+    bench_release(p);
+}
+
+__attribute__((noinline)) void operator delete[](void *p) noexcept
+{
+    bench_release(p);
+}
+
+__attribute__((noinline)) void operator delete(void *p, std::size_t) noexcept
+{
+    bench_release(p);
+}
+
+__attribute__((noinline)) void operator delete[](void *p, std::size_t) noexcept
+{
+    bench_release(p);
+}
+
+__attribute__((noinline)) void operator delete(void *p, std::align_val_t) noexcept
+{
+    bench_release(p);
+}
+
+__attribute__((noinline)) void operator delete[](void *p, std::align_val_t) noexcept
+{
+    bench_release(p);
+}
+
+__attribute__((noinline)) void operator delete(void *p, std::size_t, std::align_val_t) noexcept
+{
+    bench_release(p);
+}
+
+__attribute__((noinline)) void operator delete[](void *p, std::size_t, std::align_val_t) noexcept
+{
+    bench_release(p);
+}
+
+__attribute__((noinline)) void operator delete(void *p, const std::nothrow_t &) noexcept
+{
+    bench_release(p);
+}
+
+__attribute__((noinline)) void operator delete[](void *p, const std::nothrow_t &) noexcept
+{
+    bench_release(p);
+}
+
+// --- Latency Statistics ---
+
+// Per-call wall time and allocations of one benchmarked function
+class BenchStats
+{
+public:
+    explicit BenchStats(const std::string &name) : name(name), allocations(0), allocated_bytes(0), nodes(0) {}
+
+    // Runs `call` once and records it
+    template <typename Call>
+    void time(Call call)
+    {
+        BenchAllocations before = bench_allocations();
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        call();
+        std::chrono::steady_clock::time_point stop = std::chrono::steady_clock::now();
+        BenchAllocations after = bench_allocations();
+        micros.push_back(std::chrono::duration<double, std::micro>(stop - start).count());
+        allocations += after.count - before.count;
+        allocated_bytes += after.bytes - before.bytes;
+    }
+
+    // Search nodes (or playouts, or steps) visited by the calls, for nodes/sec
+    void add_nodes(long long n) { nodes += n; }
+
+    long long calls() const { return (long long)micros.size(); }
+
+    static void print_header(std::ostream &out)
+    {
+        char line[160];
+        std::snprintf(line, sizeof(line), "%-28s %8s %10s %10s %10s %12s %12s %12s", "function", "calls", "p50 us",
+                      "p99 us", "max us", "nodes/s", "allocs/call", "bytes/call");
+        out << line << '\n';
+    }
+
+    void print(std::ostream &out) const
+    {
+        if (micros.empty())
+            return;
+        std::vector<double> sorted = micros;
+        std::sort(sorted.begin(), sorted.end());
+        double total = 0.0;
+        for (double us : sorted)
+            total += us;
+        double n = double(sorted.size());
+        char nodes_text[32] = "-";
+        if (nodes > 0 && total > 0.0)
+            std::snprintf(nodes_text, sizeof(nodes_text), "%.0f", nodes / (total / 1e6));
+        char line[200];
+        std::snprintf(line, sizeof(line), "%-28s %8lld %10.2f %10.2f %10.2f %12s %12.1f %12.0f", name.c_str(), calls(),
+                      percentile(sorted, 0.50), percentile(sorted, 0.99), sorted.back(), nodes_text, allocations / n,
+                      allocated_bytes / n);
+        out << line << '\n';
+    }
+
+private:
+    std::string name;
+    std::vector<double> micros;
+    long long allocations;
+    long long allocated_bytes;
+    long long nodes;
+
+    // Nearest rank
+    static double percentile(const std::vector<double> &sorted, double q)
+    {
+        size_t rank = size_t(q * sorted.size() + 0.999999);
+        rank = std::min(std::max(rank, size_t(1)), sorted.size());
+        return sorted[rank - 1];
+    }
+};
@@ -0,0 +1,165 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include "flat_grid.h"
+
+// --- Bit Planes ---
+
+const int BITPLANE_WORDS = (MAX_PADDED_CELLS + 63) / 64 + 1; // +1 so bits() may read one word past the grid
+
+// One bit per FlatGrid index, so a cell's bit is addressed with the same idx the
+// grid uses and the sentinel frame is part of the plane like any other cell.
+class BitPlane
+{
+public:
+    std::array<uint64_t, BITPLANE_WORDS> words;
+
+    BitPlane() { words.fill(0); }
+
+    void clear_all() { words.fill(0); }
+    void set(int idx) { words[idx >> 6] |= uint64_t(1) << (idx & 63); }
+    void clear(int idx) { words[idx >> 6] &= ~(uint64_t(1) << (idx & 63)); }
+    bool test(int idx) const { return (words[idx >> 6] >> (idx & 63)) & 1; }
+
+    // `len` (<= 32) consecutive bits starting at `idx`, lowest bit = idx
+    uint64_t bits(int idx, int len) const
+    {
+        int w = idx >> 6, off = idx & 63;
+        uint64_t v = words[w] >> off;
+        if (off + len > 64)
+            v |= words[w + 1] << (64 - off);
+        return v & ((uint64_t(1) << len) - 1);
+    }
+
+    int popcount(int num_words = BITPLANE_WORDS) const
+    {
+        int total = 0;
+        for (int w = 0; w < num_words; ++w)
+            total += __builtin_popcountll(words[w]);
+        return total;
+    }
+};
+
+// --- Board Planes ---
+
+const int NUM_COLORS = 4; // 'A'..'D'
+
+inline int color_index(char cell)
+{
+    if (cell >= 'A' && cell <= 'D')
+        return cell - 'A';
+    if (cell >= 'a' && cell <= 'd')
+        return cell - 'a';
+    return -1;
+}
+
+// Bitboard view of a FlatGrid. A colour plane holds every cell owned by that
+// colour, sealed or not, which is exactly what Board.findColoredArea counts.
+class BoardPlanes
+{
+public:
+    BitPlane color[NUM_COLORS]; // 'A'..'D' and their sealed 'a'..'d'
+    BitPlane sealed;            // 'a'..'d'
+    BitPlane obstacle;          // '#' and the sentinel frame
+    BitPlane empty;             // '.'
+    BitPlane items;             // Cells holding a power-up
+    BitPlane blocked;           // obstacle | sealed: cells nobody can land on
+    int num_words;              // Words covering the grid's padded_size()
+
+    BoardPlanes() : num_words(0) {}
+
+    void build(const FlatGrid &grid)
+    {
+        for (int k = 0; k < NUM_COLORS; ++k)
+            color[k].clear_all();
+        sealed.clear_all();
+        obstacle.clear_all();
+        empty.clear_all();
+        items.clear_all();
+        blocked.clear_all();
+        num_words = (grid.padded_size() + 63) / 64;
+        for (int i = 0; i < grid.padded_size(); ++i)
+            add_cell(i, grid[i]);
+    }
+
+    // Cells within `radius` (<= GRID_PAD) of `center` that are set in none of the
+    // planes OR-ed into `excluded`, e.g. the paint bomb's paintable cells.
+    template <typename... Planes>
+    int count_window_free(const FlatGrid &grid, int center, int radius, const Planes &...excluded) const
+    {
+        int len = 2 * radius + 1;
+        int total = 0;
+        for (int dr = -radius; dr <= radius; ++dr)
+        {
+            int start = center + grid.delta(dr, -radius);
+            uint64_t taken = (excluded.bits(start, len) | ... | 0);
+            total += len - __builtin_popcountll(taken);
+        }
+        return total;
+    }
+
+private:
+    void add_cell(int idx, char cell)
+    {
+        int k = color_index(cell);
+        if (k >= 0)
+            color[k].set(idx);
+        if (is_sealed_cell(cell))
+            sealed.set(idx);
+        if (cell == OBSTACLE_CELL || cell == BORDER_CELL)
+            obstacle.set(idx);
+        if (cell == EMPTY_CELL)
+            empty.set(idx);
+        if (is_blocked_cell(cell))
+            blocked.set(idx);
+    }
+};
+
+// Just the colour and blocked planes, for a board that changes every step.
+// SimState keeps one in step with its grid, so an area is a popcount and the
+// enclosure check reads its walls without a scan.
+class ColorPlanes
+{
+public:
+    BitPlane color[NUM_COLORS]; // 'A'..'D' and their sealed 'a'..'d'
+    BitPlane blocked;           // is_blocked_cell
+    int num_words;              // Words covering the grid's padded_size()
+
+    ColorPlanes() : num_words(0) {}
+
+    void build(const FlatGrid &grid)
+    {
+        for (int k = 0; k < NUM_COLORS; ++k)
+            color[k].clear_all();
+        blocked.clear_all();
+        num_words = (grid.padded_size() + 63) / 64;
+        for (int i = 0; i < grid.padded_size(); ++i)
+        {
+            int k = color_index(grid[i]);
+            if (k >= 0)
+                color[k].set(i);
+            if (is_blocked_cell(grid[i]))
+                blocked.set(i);
+        }
+    }
+
+    // Keeps the planes in sync after grid[idx] changes from old_cell to new_cell
+    void set_cell(int idx, char old_cell, char new_cell)
+    {
+        int k = color_index(old_cell);
+        if (k >= 0)
+            color[k].clear(idx);
+        k = color_index(new_cell);
+        if (k >= 0)
+            color[k].set(idx);
+        if (is_blocked_cell(new_cell))
+            blocked.set(idx);
+        else
+            blocked.clear(idx);
+    }
+
+    // Board.findColoredArea
+    int area_of(int color_idx) const { return color[color_idx].popcount(num_words); }
+};
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <stddef.h>
+
+// --- Bot Plugin ABI ---
+//
+// Every bot in Source/ also builds as a shared library that exports the C
+// functions below, for example
+//   g++ -O2 -std=c++17 -pthread -shared -fPIC -DBOT_LIBRARY Source/bot/main.cpp -o libbot.so
+// (-DBOT_LIBRARY leaves main out). A host can then play whole games in one
+// process, without writing MAP.INP or reading MOVE.OUT and without starting
+// a process per turn. main.exe itself is a thin wrapper around the same
+// functions.
+//
+// A turn is passed in as exactly the MAP.INP text the simulator would have
+// written for it. The bot keeps what it would otherwise save in STATE.DAT
+// (its power-up counters) inside the instance, and it also keeps its
+// per-game tables there. If a turn's number does not increase, a new game
+// has started. Calls on one instance must not overlap. Separate instances
+// share nothing unless the bot says otherwise.
+
+#define BOT_API_VERSION 1
+
+#if defined(_WIN32)
+#define BOT_API __declspec(dllexport)
+#else
+#define BOT_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+typedef struct BotInstance BotInstance;
+
+// BOT_API_VERSION the library was built with
+BOT_API int bot_api_version(void);
+
+// `options` takes the command-line arguments main.exe accepts, separated
+// by spaces (NULL or "" for the defaults). Unknown ones are reported on
+// stderr and ignored.
+BOT_API BotInstance *bot_create(const char *options);
+
+// Starts a new game on the map in `map_text` (any of its turns, usually
+// turn 0) and forgets the previous one. Returns 0, or -1 if the text does
+// not parse.
+BOT_API int bot_init(BotInstance *bot, const char *map_text, size_t length);
+
+// Decides the move for the turn in `map_text` and writes it to (*x, *y),
+// which is what main.exe would write to MOVE.OUT. Returns 0, or -1 if the
+// text does not parse, in which case the move is whatever main.exe would
+// fall back to (bot and Greedy: the last known position).
+BOT_API int bot_decide(BotInstance *bot, const char *map_text, size_t length, int *x, int *y);
+
+// Forgets the current game, so the next call plays as if on a new instance
+BOT_API void bot_reset(BotInstance *bot);
+
+BOT_API void bot_destroy(BotInstance *bot);
+
+// Optional: the instance's evaluate_move weights as "name=value,..." (see
+// eval_weights.h), which --weights= in `options` accepts back. The text
+// stays valid until the next call on the instance. Hosts look it up with
+// dlsym and treat a bot without it as having no tunable weights.
+BOT_API const char *bot_weights(BotInstance *bot);
+
+// Signatures for hosts that look the functions up at run time
+typedef int (*BotApiVersionFn)(void);
+typedef BotInstance *(*BotCreateFn)(const char *options);
+typedef int (*BotInitFn)(BotInstance *bot, const char *map_text, size_t length);
+typedef int (*BotDecideFn)(BotInstance *bot, const char *map_text, size_t length, int *x, int *y);
+typedef void (*BotResetFn)(BotInstance *bot);
+typedef void (*BotDestroyFn)(BotInstance *bot);
+typedef const char *(*BotWeightsFn)(BotInstance *bot);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "bitboard.h"
+#include "flat_grid.h"
+
+// --- Distance Fields ---
+//
+// Walking distances (4-neighbour steps, no power-ups) from a source cell to
+// every cell of the board. Obstacles and sealed cells only change when
+// Board.shrink fires every K turns, so a field stays valid for a whole shrink
+// epoch: fields are built on first use, one BFS per source cell, and kept
+// until set_walls() sees a different wall plane. Items sit on the board for
+// several turns and players keep crossing the same cells, so most lookups in
+// an epoch hit a field that already exists.
+
+const uint16_t DISTANCE_UNREACHABLE = 0xFFFF;
+
+class DistanceFields
+{
+public:
+    DistanceFields() : stride(0), padded_size(0), num_words(0), num_fields(0), builds(0) {}
+
+    // Drops every field unless `walls` and the grid's shape are the ones the
+    // fields were built for. Returns true if the cache was kept.
+    bool set_walls(const FlatGrid &grid, const BitPlane &new_walls)
+    {
+        int words = (grid.padded_size() + 63) / 64;
+        if (grid.stride == stride && grid.padded_size() == padded_size && same_words(new_walls, words))
+            return true;
+        stride = grid.stride;
+        padded_size = grid.padded_size();
+        num_words = words;
+        walls = new_walls;
+        slot_of.assign(padded_size, -1);
+        num_fields = 0;
+        queue.reserve(padded_size);
+        return false;
+    }
+
+    // Distance from `source` to every padded index, DISTANCE_UNREACHABLE for
+    // walls and cells cut off from it. `source` itself is 0 even if it is a
+    // wall. The pointer stays valid until the next set_walls().
+    const uint16_t *from(int source)
+    {
+        int slot = slot_of[source];
+        if (slot < 0)
+        {
+            slot = slot_of[source] = num_fields++;
+            if (int(fields.size()) < num_fields)
+                fields.emplace_back();
+            build(source, fields[slot]);
+        }
+        return fields[slot].data();
+    }
+
+    // Steps from `source` to `target`, or -1 if `target` cannot be reached
+    int distance(int source, int target)
+    {
+        uint16_t d = from(source)[target];
+        return d == DISTANCE_UNREACHABLE ? -1 : d;
+    }
+
+    bool is_wall(int idx) const { return walls.test(idx); }
+
+    int cached_fields() const { return num_fields; }
+    long long total_builds() const { return builds; } // BFS runs since construction
+
+private:
+    BitPlane walls;
+    int stride;
+    int padded_size;
+    int num_words;
+    std::vector<int> slot_of;                  // Padded index -> field, -1 if not built this epoch
+    std::vector<std::vector<uint16_t>> fields; // Buffers are reused across epochs
+    int num_fields;
+    std::vector<int> queue;
+    long long builds;
+
+    bool same_words(const BitPlane &other, int words) const
+    {
+        if (words != num_words)
+            return false;
+        for (int w = 0; w < words; ++w)
+        {
+            if (walls.words[w] != other.words[w])
+                return false;
+        }
+        return true;
+    }
+
+    // The sentinel frame is part of the walls, so the BFS needs no bounds check
+    void build(int source, std::vector<uint16_t> &dist)
+    {
+        ++builds;
+        dist.assign(padded_size, DISTANCE_UNREACHABLE);
+        const int offsets[4] = {-stride, stride, -1, 1};
+        queue.clear();
+        queue.push_back(source);
+        dist[source] = 0;
+        for (size_t head = 0; head < queue.size(); ++head)
+        {
+            int curr = queue[head];
+            uint16_t next_dist = uint16_t(dist[curr] + 1);
+            for (int offset : offsets)
+            {
+                int next = curr + offset;
+                if (dist[next] == DISTANCE_UNREACHABLE && !walls.test(next))
+                {
+                    dist[next] = next_dist;
+                    queue.push_back(next);
+                }
+            }
+        }
+    }
+};
@@ -0,0 +1,282 @@
+#pragma once
+
+#include <cstdint>
+
+#include "bitboard.h"
+#include "flat_grid.h"
+
+// --- Enclosure ---
+//
+// Board.updateCoveredArea gives colour C every movable cell from which
+// checkBorderReachable fails, i.e. with no path to the board's edge through
+// cells that are not C (sealed or not; obstacles are crossed). That set is the
+// complement of a single flood fill from the edge, computed here as a
+// bit-parallel dilation: each sweep grows the reached plane by one cell in all
+// four directions for the whole board at once, so a turn costs a few passes
+// over ~10 words on a 21x21 board instead of a BFS per cell.
+//
+// Between two steps of a game a colour's cells change by a handful, so the
+// forward model also keeps what the edge reached last time per colour and
+// patches it one changed cell at a time, falling back to the fill whenever a
+// change could split or join regions.
+
+// What the edge reached the last time one colour's cells were filled
+class EnclosureMemo
+{
+public:
+    BitPlane walls;
+    BitPlane reach;
+    int M, N; // Board the memo was made on, 0 while there is none
+
+    EnclosureMemo() : M(0), N(0) {}
+};
+
+class EnclosureMap
+{
+public:
+    BitPlane inside; // Cells on the board
+    BitPlane edge;   // Row 0, row M-1, column 0 and column N-1
+    int num_words;
+    int stride;
+    int M, N;
+
+    EnclosureMap() : num_words(0), stride(0), M(0), N(0) {}
+
+    // Only depends on the board's shape, so callers may skip it while M and N stay put
+    void build(const FlatGrid &grid)
+    {
+        M = grid.M;
+        N = grid.N;
+        stride = grid.stride;
+        num_words = (grid.padded_size() + 63) / 64;
+        inside.clear_all();
+        edge.clear_all();
+        for (int r = 0; r < M; ++r)
+        {
+            for (int c = 0; c < N; ++c)
+            {
+                int idx = grid.idx(r, c);
+                inside.set(idx);
+                if (r == 0 || c == 0 || r == M - 1 || c == N - 1)
+                    edge.set(idx);
+            }
+        }
+    }
+
+    bool matches(const FlatGrid &grid) const
+    {
+        return grid.M == M && grid.N == N && grid.stride == stride;
+    }
+
+    // Board cells outside `walls` that the edge cannot reach without crossing `walls`
+    void cut_off_cells(const BitPlane &walls, BitPlane &out) const
+    {
+        fill_reach(walls, out);
+        cut_off_from_reach(walls, out, out);
+    }
+
+    // The same, patching `memo` when `walls` is at most MEMO_MAX_CHANGES
+    // cells away from the walls it was made with
+    void cut_off_cells(const BitPlane &walls, BitPlane &out, EnclosureMemo &memo) const
+    {
+        if (memo.M != M || memo.N != N || !patch_reach(walls, memo))
+            fill_reach(walls, memo.reach);
+        for (int w = 0; w < num_words; ++w)
+            memo.walls.words[w] = walls.words[w];
+        memo.M = M;
+        memo.N = N;
+        cut_off_from_reach(walls, memo.reach, out);
+    }
+
+    // Cells updateCoveredArea would hand to the colour whose cells (sealed
+    // included) are `walls`: cut off, movable and not that colour already.
+    // Returns how many there are.
+    int captured_cells(const BitPlane &walls, const BitPlane &blocked, BitPlane &out) const
+    {
+        cut_off_cells(walls, out);
+        return drop_blocked(blocked, out);
+    }
+
+    int captured_cells(const BitPlane &walls, const BitPlane &blocked, BitPlane &out, EnclosureMemo &memo) const
+    {
+        cut_off_cells(walls, out, memo);
+        return drop_blocked(blocked, out);
+    }
+
+private:
+    static const int MEMO_MAX_CHANGES = 16;
+
+    // Cells the edge reaches without crossing `walls`
+    void fill_reach(const BitPlane &walls, BitPlane &reach) const
+    {
+        for (int w = 0; w < num_words; ++w)
+            reach.words[w] = edge.words[w] & ~walls.words[w];
+
+        // Growing the plane in place only ever adds cells the fill can reach,
+        // so sweeping forward and backward alternately still converges to the
+        // same fixed point, just in fewer rounds.
+        bool changed = true;
+        for (int round = 0; changed; ++round)
+        {
+            changed = false;
+            bool forward = (round % 2 == 0);
+            for (int k = 0; k < num_words; ++k)
+            {
+                int w = forward ? k : num_words - 1 - k;
+                uint64_t grown = reach.words[w] | dilate(reach, w);
+                grown &= inside.words[w] & ~walls.words[w];
+                if (grown != reach.words[w])
+                {
+                    reach.words[w] = grown;
+                    changed = true;
+                }
+            }
+        }
+    }
+
+    void cut_off_from_reach(const BitPlane &walls, const BitPlane &reach, BitPlane &out) const
+    {
+        for (int w = 0; w < num_words; ++w)
+            out.words[w] = inside.words[w] & ~walls.words[w] & ~reach.words[w];
+        for (int w = num_words; w < BITPLANE_WORDS; ++w)
+            out.words[w] = 0;
+    }
+
+    int drop_blocked(const BitPlane &blocked, BitPlane &out) const
+    {
+        int total = 0;
+        for (int w = 0; w < num_words; ++w)
+        {
+            out.words[w] &= ~blocked.words[w];
+            total += __builtin_popcountll(out.words[w]);
+        }
+        return total;
+    }
+
+    bool is_open(const BitPlane &walls, int idx) const
+    {
+        return inside.test(idx) && !walls.test(idx);
+    }
+
+    // Moves memo.reach over to `walls` one changed cell at a time. Gives up,
+    // leaving the memo half done, on a change only a new fill can settle.
+    bool patch_reach(const BitPlane &walls, EnclosureMemo &memo) const
+    {
+        int changes[MEMO_MAX_CHANGES];
+        int num_changes = 0;
+        for (int w = 0; w < num_words; ++w)
+        {
+            for (uint64_t diff = walls.words[w] ^ memo.walls.words[w]; diff; diff &= diff - 1)
+            {
+                if (num_changes == MEMO_MAX_CHANGES)
+                    return false;
+                changes[num_changes++] = w * 64 + __builtin_ctzll(diff);
+            }
+        }
+
+        BitPlane &now = memo.walls;
+        BitPlane &reach = memo.reach;
+        const int sides[4] = {-stride, 1, stride, -1};
+        for (int i = 0; i < num_changes; ++i)
+        {
+            int idx = changes[i];
+            if (walls.test(idx))
+            {
+                // A new wall only takes cells away if it was reached itself
+                now.set(idx);
+                if (!reach.test(idx))
+                    continue;
+                if (!stays_reached(now, idx))
+                    return false;
+                reach.clear(idx);
+                continue;
+            }
+
+            // A freed cell is reached if it touches the edge or a reached
+            // cell, and then brings along any cut-off cell next to it
+            now.clear(idx);
+            bool reached = edge.test(idx);
+            for (int d = 0; d < 4 && !reached; ++d)
+                reached = reach.test(idx + sides[d]);
+            if (!reached)
+                continue;
+            for (int d = 0; d < 4; ++d)
+            {
+                int next = idx + sides[d];
+                if (is_open(now, next) && !reach.test(next))
+                    return false;
+            }
+            reach.set(idx);
+        }
+        return true;
+    }
+
+    // Whether the open cells beside the reached cell idx stay reached once it
+    // is walled. Walking around its eight neighbours, the open ones that
+    // touch idx must lie in one run, which connects them without idx (unless
+    // idx was on the edge and reached them from there), or every such run
+    // must hold an edge cell of its own.
+    bool stays_reached(const BitPlane &walls, int idx) const
+    {
+        const int ring[8] = {-stride, -stride + 1, 1, stride + 1, stride, stride - 1, -1, -stride - 1};
+        int open = 0, on_edge = 0;
+        for (int j = 0; j < 8; ++j)
+        {
+            if (is_open(walls, idx + ring[j]))
+            {
+                open |= 1 << j;
+                if (edge.test(idx + ring[j]))
+                    on_edge |= 1 << j;
+            }
+        }
+        if (open == 0xFF) // So idx is off the edge, which always has padding beside it
+            return true;
+
+        // Start after a closed neighbour so no run wraps around
+        int start = 0;
+        while (open >> start & 1)
+            ++start;
+        int runs = 0, unanchored = 0;
+        bool touches = false, anchored = false;
+        for (int j = 1; j <= 8; ++j)
+        {
+            int bit = (start + j) % 8;
+            if (open >> bit & 1)
+            {
+                touches |= (bit % 2 == 0); // Even bits are the four sides
+                anchored |= bool(on_edge >> bit & 1);
+                continue;
+            }
+            if (touches)
+            {
+                ++runs;
+                unanchored += !anchored;
+            }
+            touches = anchored = false;
+        }
+        return unanchored == 0 || (runs == 1 && !edge.test(idx));
+    }
+
+    // Bits of word w whose left, right, upper or lower neighbour is set in `plane`
+    uint64_t dilate(const BitPlane &plane, int w) const
+    {
+        uint64_t cur = plane.words[w];
+        uint64_t lo = w > 0 ? plane.words[w - 1] : 0;
+        uint64_t hi = w + 1 < num_words ? plane.words[w + 1] : 0;
+
+        uint64_t from_left = (cur << 1) | (lo >> 63);
+        uint64_t from_right = (cur >> 1) | (hi << 63);
+        uint64_t from_up, from_down;
+        if (stride >= 64) // stride is at most MAX_PADDED_DIM == 64
+        {
+            from_up = lo;
+            from_down = hi;
+        }
+        else
+        {
+            from_up = (cur << stride) | (lo >> (64 - stride));
+            from_down = (cur >> stride) | (hi << (64 - stride));
+        }
+        return from_left | from_right | from_up | from_down;
+    }
+};
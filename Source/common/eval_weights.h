@@ -0,0 +1,154 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "map_parser.h" // map_parse_fail
+
+// --- Evaluation Weights ---
+//
+// The constants a bot's evaluate_move adds up, as a vector of named numbers.
+// Each bot keeps its compiled-in table next to evaluate_move, in the order of
+// its weight enum. `--weights=name=value,...` (main.exe and bot_create)
+// overrides some of them for one instance, which is how Source/tuner plays
+// perturbed copies of a bot against each other. All weights are magnitudes
+// (penalties are subtracted), so none is ever negative.
+//
+// evaluate_move is a template over an evaluation policy: the game rules it
+// relies on as constants, plus `w[i]` for weight i. FixedWeights reads a
+// constexpr table, so every weight folds into the code and a term whose
+// weight is 0 disappears along with whatever it would have computed.
+// RuntimeWeights reads an EvalWeights instead; bots play through it when
+// given --weights, so the tuner and arena can try any vector without a
+// rebuild (`--weights=` alone runs the defaults that way).
+
+const int MAX_EVAL_WEIGHTS = 32;
+
+// The rules evaluate_move assumes, as Simulator/main.py plays them (the same
+// numbers as forward_model.h)
+struct StandardRules
+{
+    static constexpr int BOMB_RADIUS = 1; // A paint bomb colours the 3x3 square around it
+    static constexpr int BOOST_TURNS = 5; // Player.setTangToc
+    static constexpr int OIL_TURNS = 5;   // Player.setDauTron: turns to use the oil slick before it vanishes
+};
+
+// One weight and its compiled-in value
+struct EvalParam
+{
+    const char *name;
+    double value;
+};
+
+// Shortest decimal text that reads back as exactly `value`
+inline std::string format_weight(double value)
+{
+    char text[32];
+    if (value == std::floor(value) && std::fabs(value) < 1e15)
+    {
+        std::snprintf(text, sizeof(text), "%.0f", value);
+        return text;
+    }
+    for (int digits = 1; digits <= 17; ++digits)
+    {
+        std::snprintf(text, sizeof(text), "%.*g", digits, value);
+        if (std::strtod(text, nullptr) == value)
+            break;
+    }
+    return text;
+}
+
+class EvalWeights
+{
+public:
+    EvalWeights() = default;
+
+    template <int N>
+    explicit EvalWeights(const EvalParam (&table)[N]) : table(table), count(N)
+    {
+        static_assert(N <= MAX_EVAL_WEIGHTS, "raise MAX_EVAL_WEIGHTS");
+        for (int i = 0; i < N; ++i)
+            values[i] = table[i].value;
+    }
+
+    double operator[](int i) const { return values[i]; }
+    int size() const { return count; }
+    bool is_overridden() const { return overridden; } // parse() was called
+    const char *name(int i) const { return table[i].name; }
+
+    // Index of the weight called `name`, -1 if there is none
+    int find(const std::string &name) const
+    {
+        for (int i = 0; i < count; ++i)
+        {
+            if (name == table[i].name)
+                return i;
+        }
+        return -1;
+    }
+
+    // Sets the weights listed in "name=value,name=value". Nothing changes
+    // unless the whole list is valid.
+    bool parse(const std::string &text, std::string *error = nullptr)
+    {
+        std::array<double, MAX_EVAL_WEIGHTS> parsed = values;
+        size_t start = 0;
+        while (start < text.size())
+        {
+            size_t end = text.find(',', start);
+            if (end == std::string::npos)
+                end = text.size();
+            std::string item = text.substr(start, end - start);
+            start = end + 1;
+            size_t equals = item.find('=');
+            int i = find(item.substr(0, equals));
+            if (equals == std::string::npos || i < 0)
+                return map_parse_fail(error, "unknown weight '" + item.substr(0, equals) + "'");
+            const char *number = item.c_str() + equals + 1;
+            char *number_end = nullptr;
+            double value = std::strtod(number, &number_end);
+            if (number_end == number || *number_end != '\0' || !(value >= 0.0))
+                return map_parse_fail(error, "bad value for weight '" + item.substr(0, equals) + "'");
+            parsed[i] = value;
+        }
+        values = parsed;
+        overridden = true;
+        return true;
+    }
+
+    // Every weight as "name=value,..." in table order, which parse() reads back
+    std::string format() const
+    {
+        std::string text;
+        for (int i = 0; i < count; ++i)
+            text += (i ? "," : "") + std::string(table[i].name) + "=" + format_weight(values[i]);
+        return text;
+    }
+
+private:
+    const EvalParam *table = nullptr;
+    int count = 0;
+    bool overridden = false;
+    std::array<double, MAX_EVAL_WEIGHTS> values{};
+};
+
+// Compiled-in weights: TABLE is a constexpr EvalParam array
+template <const EvalParam *TABLE, typename Rules = StandardRules>
+struct FixedWeights : Rules
+{
+    constexpr double operator[](int i) const { return TABLE[i].value; }
+};
+
+// Weights chosen at run time
+template <typename Rules = StandardRules>
+struct RuntimeWeights : Rules
+{
+    const EvalWeights *weights;
+
+    explicit RuntimeWeights(const EvalWeights &weights) : weights(&weights) {}
+    double operator[](int i) const { return (*weights)[i]; }
+};
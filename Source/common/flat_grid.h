@@ -0,0 +1,76 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+
+// --- Cell Constants (shared by every bot) ---
+const char EMPTY_CELL = '.';
+const char OBSTACLE_CELL = '#';
+const char BORDER_CELL = '+'; // Sentinel frame around the board, never appears in MAP.INP
+const char SPEED_BOOST_ITEM = 'G';
+const char PAINT_BOMB_ITEM = 'E';
+const char OIL_SLICK_ITEM = 'F';
+
+inline bool is_sealed_cell(char cell)
+{
+    return cell >= 'a' && cell <= 'd';
+}
+
+// '#', sealed cells and the sentinel frame can never be landed on
+inline bool is_blocked_cell(char cell)
+{
+    return cell == OBSTACLE_CELL || cell == BORDER_CELL || is_sealed_cell(cell);
+}
+
+// --- Flat Grid ---
+
+// Width of the sentinel frame. Every probe the bots make is at most two cells
+// away from a playable cell (speed boost, oil slick landing, 5x5 paint bomb),
+// so it always lands inside the buffer and never needs a bounds check.
+const int GRID_PAD = 2;
+const int MAX_BOARD_DIM = 60;
+const int MAX_PADDED_DIM = MAX_BOARD_DIM + 2 * GRID_PAD;
+const int MAX_PADDED_CELLS = MAX_PADDED_DIM * MAX_PADDED_DIM;
+
+// Row-major M x N board in one contiguous buffer. Cell (r, c) lives at
+// idx(r, c); its neighbours are idx -/+ stride (up/down) and idx -/+ 1 (left/right).
+class FlatGrid
+{
+public:
+    int M, N, stride;
+    std::array<char, MAX_PADDED_CELLS> cells;
+
+    FlatGrid() : M(0), N(0), stride(2 * GRID_PAD)
+    {
+        cells.fill(BORDER_CELL);
+    }
+
+    // Caller guarantees rows, cols <= MAX_BOARD_DIM
+    void reset(int rows, int cols, char fill = EMPTY_CELL)
+    {
+        M = rows;
+        N = cols;
+        stride = N + 2 * GRID_PAD;
+        std::fill(cells.begin(), cells.begin() + padded_size(), BORDER_CELL);
+        for (int r = 0; r < M; ++r)
+        {
+            std::fill(cells.begin() + idx(r, 0), cells.begin() + idx(r, 0) + N, fill);
+        }
+    }
+
+    int idx(int r, int c) const { return (r + GRID_PAD) * stride + (c + GRID_PAD); }
+    int row_of(int i) const { return i / stride - GRID_PAD; }
+    int col_of(int i) const { return i % stride - GRID_PAD; }
+    int delta(int dr, int dc) const { return dr * stride + dc; }
+    int padded_size() const { return (M + 2 * GRID_PAD) * stride; }
+
+    bool is_within_bounds(int r, int c) const
+    {
+        return r >= 0 && r < M && c >= 0 && c < N;
+    }
+
+    char &at(int r, int c) { return cells[idx(r, c)]; }
+    char at(int r, int c) const { return cells[idx(r, c)]; }
+    char &operator[](int i) { return cells[i]; }
+    char operator[](int i) const { return cells[i]; }
+};
@@ -0,0 +1,834 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+#include "bitboard.h"
+#include "enclosure.h"
+#include "flat_grid.h"
+#include "seal_schedule.h"
+#include "zobrist.h"
+
+// --- Forward Model ---
+//
+// Applies one simulator turn to a SimState with the semantics of
+// Simulator/main.py, player.py (moveNext), board.py (updateCoveredArea,
+// shrink) and powerUp.py (timeouts). Quirks of the reference simulator are
+// reproduced on purpose, because the bots are scored by it:
+//   - A player's 2-step mid cell (lastMidCell) is only cleared by a validated
+//     move, so staying put after a boosted move repaints the old mid cell.
+//   - A-C cells under a player are repainted even while speed boost is active;
+//     only 'D' and '.' respect the boost (operator precedence in main.py).
+//   - The paint bomb 'E' covers 3x3 and kills only the first occupant of a cell.
+//   - Players killed during the painting pass still paint and pick up items in
+//     that pass, since the occupancy table is built before it.
+//   - Oil slick ('F') lets a player step onto one adjacent '#' cell.
+//
+// A step never allocates: SimState is a fixed-size value and all scratch
+// buffers live in ForwardModel. It also keeps SimState::hash current, touching
+// only the keys of what changed. Searches that walk a tree can use make_move /
+// unmake_move instead of copying the state for every child.
+
+enum PowerUpKind : uint8_t
+{
+    POWERUP_NONE = 0,
+    POWERUP_SPEED_BOOST, // "tangtoc", from 'G'
+    POWERUP_OIL_SLICK    // "dautron", from 'F'
+};
+
+const int MAX_SIM_PLAYERS = 4;
+const int MAX_SIM_ITEMS = 16;
+const int POWERUP_DURATION = 5; // Player.setTangToc / Player.setDauTron
+const int PAINT_BOMB_RADIUS = 1; // 3x3 in main.py
+
+static_assert(MAX_SIM_PLAYERS <= NUM_COLORS && POWERUP_DURATION < ZOBRIST_MAX_TIMER, "Zobrist tables too small");
+
+struct SimPlayer
+{
+    int pos; // FlatGrid index, -1 once dead or before placement
+    bool alive;
+    char color;
+    int8_t boost_turns; // Player.tangtoc
+    int8_t oil_turns;   // Player.dautron
+    uint8_t powerup;    // PowerUpKind
+    int last_mid;       // Player.lastMidCell as a grid index, -1 for None
+};
+
+struct SimItem
+{
+    int pos;
+    char type;
+    int timeout;
+};
+
+struct SimMove
+{
+    int x, y; // What the bot writes to MOVE.OUT
+};
+
+struct SimState
+{
+    FlatGrid grid;
+    int turn;   // Turn about to be played
+    int K;      // Shrink / spawn period ("frequency")
+    int radius; // Next ring Board.shrink will seal
+    int num_players;
+    std::array<SimPlayer, MAX_SIM_PLAYERS> players; // Indexed by colour, 'A' + i
+    int num_items;
+    std::array<SimItem, MAX_SIM_ITEMS> items;
+    // Zobrist key of everything step() reads except item timeouts, which
+    // follow from the turn. The setters below keep it current; call rehash()
+    // after writing fields directly.
+    uint64_t hash;
+    ColorPlanes colors; // The grid's colours; kept by set_cell, rebuilt by rehash()
+
+    SimState() : turn(0), K(0), radius(0), num_players(0), num_items(0), hash(0) { rehash(); }
+
+    void set_cell(int idx, char cell)
+    {
+        const ZobristKeys &keys = zobrist_keys();
+        hash ^= keys.cell_key(idx, grid[idx]) ^ keys.cell_key(idx, cell);
+        colors.set_cell(idx, grid[idx], cell);
+        grid[idx] = cell;
+    }
+
+    // set_cell without the hash, for undoing a step whose hash is restored whole
+    void restore_cell(int idx, char cell)
+    {
+        colors.set_cell(idx, grid[idx], cell);
+        grid[idx] = cell;
+    }
+
+    void set_turn(int t)
+    {
+        const ZobristKeys &keys = zobrist_keys();
+        hash ^= keys.turn_key(turn) ^ keys.turn_key(t);
+        turn = t;
+    }
+
+    void set_radius(int r)
+    {
+        const ZobristKeys &keys = zobrist_keys();
+        hash ^= keys.radius_key(radius) ^ keys.radius_key(r);
+        radius = r;
+    }
+
+    // Position, power-up and mid cell of player i; 0 once dead. Changes to a
+    // player are hashed by XOR-ing this out before and back in after.
+    uint64_t player_key(int i) const
+    {
+        const SimPlayer &p = players[i];
+        if (!p.alive || p.pos < 0)
+            return 0;
+        const ZobristKeys &keys = zobrist_keys();
+        int turns = p.powerup == POWERUP_SPEED_BOOST ? p.boost_turns : p.oil_turns;
+        uint64_t h = keys.player[i][p.pos] ^ keys.powerup_key(i, p.powerup, turns);
+        if (p.last_mid >= 0)
+            h ^= keys.last_mid[i][p.last_mid];
+        return h;
+    }
+
+    uint64_t compute_hash() const
+    {
+        const ZobristKeys &keys = zobrist_keys();
+        uint64_t h = keys.turn_key(turn) ^ keys.radius_key(radius);
+        for (int r = 0; r < grid.M; ++r)
+        {
+            int idx = grid.idx(r, 0);
+            for (int c = 0; c < grid.N; ++c, ++idx)
+                h ^= keys.cell_key(idx, grid[idx]);
+        }
+        for (int i = 0; i < num_players; ++i)
+            h ^= player_key(i);
+        for (int k = 0; k < num_items; ++k)
+            h ^= keys.item_key(items[k].pos, items[k].type);
+        return h;
+    }
+
+    void rehash()
+    {
+        hash = compute_hash();
+        colors.build(grid);
+    }
+
+    int count_alive() const
+    {
+        int alive = 0;
+        for (int i = 0; i < num_players; ++i)
+            alive += players[i].alive;
+        return alive;
+    }
+
+    int find_item(int pos) const
+    {
+        for (int i = 0; i < num_items; ++i)
+        {
+            if (items[i].pos == pos)
+                return i;
+        }
+        return -1;
+    }
+
+    void remove_item(int item_idx)
+    {
+        hash ^= zobrist_keys().item_key(items[item_idx].pos, items[item_idx].type);
+        for (int i = item_idx + 1; i < num_items; ++i)
+            items[i - 1] = items[i];
+        --num_items;
+    }
+
+    bool add_item(int pos, char type, int timeout)
+    {
+        if (num_items >= MAX_SIM_ITEMS || find_item(pos) >= 0)
+            return false;
+        items[num_items++] = {pos, type, timeout};
+        hash ^= zobrist_keys().item_key(pos, type);
+        return true;
+    }
+
+    // Board.findColoredArea for one colour (sealed cells count too)
+    int area_of(int color_idx) const { return colors.area_of(color_idx); }
+
+    // Board.checkGameStopped: nothing left to move onto
+    bool is_game_over() const
+    {
+        for (int r = 0; r < grid.M; ++r)
+        {
+            const char *row = &grid.cells[grid.idx(r, 0)];
+            for (int c = 0; c < grid.N; ++c)
+            {
+                if (row[c] == EMPTY_CELL || (row[c] >= 'A' && row[c] <= 'D'))
+                    return false;
+            }
+        }
+        return true;
+    }
+};
+
+// Board.checkUnmovable; the sentinel frame plays the role of "off the board"
+inline bool is_unmovable_cell(char cell)
+{
+    return is_blocked_cell(cell);
+}
+
+inline char upper_cell(char cell)
+{
+    return is_sealed_cell(cell) ? char(cell - 'a' + 'A') : cell;
+}
+
+struct StepResult
+{
+    bool shrank;     // Board.shrink ran at the end of this turn
+    bool spawn_due;  // main.py would call addPowerUp now; spawning is random, so it is left to the caller
+    int killed_mask; // Bit i set if player i died during the step
+};
+
+// Holds ~70 KB of scratch plus the undo stack, so keep one around (static or
+// per search) rather than making one per step.
+class ForwardModel
+{
+public:
+    ForwardModel() : recording(false)
+    {
+        e_count.fill(0);
+        boost_count.fill(0);
+        cell_changes.reserve(1 << 12);
+        undo_frames.reserve(256);
+    }
+
+    // main.py turn 0: ListOfPlayers.chooseStartingPositions. A player asking for
+    // an unmovable cell is put on fallback_cells[i] instead (main.py draws it at random).
+    void place_players(SimState &s, const SimMove *moves, const int *fallback_cells) const
+    {
+        for (int i = 0; i < s.num_players; ++i)
+        {
+            s.hash ^= s.player_key(i);
+            SimPlayer &p = s.players[i];
+            int x = moves[i].x, y = moves[i].y;
+            bool inside = s.grid.is_within_bounds(x, y);
+            p.pos = (inside && !is_unmovable_cell(s.grid.at(x, y))) ? s.grid.idx(x, y) : fallback_cells[i];
+            p.alive = true;
+            p.color = char('A' + i);
+            p.boost_turns = p.oil_turns = 0;
+            p.powerup = POWERUP_NONE;
+            p.last_mid = -1;
+            s.hash ^= s.player_key(i);
+        }
+    }
+
+    // One full turn of main.py after the bots answered. On turn 0 call
+    // place_players() first and pass the same moves (they are ignored).
+    StepResult step(SimState &s, const SimMove *moves)
+    {
+        StepResult result = {false, false, 0};
+        int alive_before = alive_mask(s);
+        // Players change all through the turn; rehash them once at the end
+        for (int i = 0; i < s.num_players; ++i)
+            s.hash ^= s.player_key(i);
+
+        if (s.turn > 0)
+        {
+            for (int i = 0; i < s.num_players; ++i)
+                move_player(s, s.players[i], moves[i]);
+        }
+
+        // Occupancy is taken once, before painting (the `cells` table in main.py)
+        std::array<int, MAX_SIM_PLAYERS> occupied_pos;
+        for (int i = 0; i < s.num_players; ++i)
+            occupied_pos[i] = s.players[i].alive ? s.players[i].pos : -1;
+
+        num_e_cells = num_boost_cells = 0;
+        paint_occupied_cells(s, occupied_pos);
+        apply_paint_bombs(s, occupied_pos);
+        apply_speed_boost_cells(s);
+
+        capture_enclosed_areas(s);
+        update_item_timeouts(s);
+
+        if (s.turn > 0 && s.K > 0 && (s.turn % s.K == 0 || s.count_alive() <= 0))
+        {
+            shrink(s);
+            result.shrank = true;
+        }
+        result.spawn_due = (s.K > 0 && s.turn % s.K == 0);
+
+        s.set_turn(s.turn + 1);
+        for (int i = 0; i < s.num_players; ++i)
+            s.hash ^= s.player_key(i);
+        result.killed_mask = alive_before & ~alive_mask(s);
+        return result;
+    }
+
+    // step() that can be taken back with unmake_move(). Moves nest like a
+    // stack. Only changed cells are logged; players, items and counters are
+    // saved whole, which is a few hundred bytes. The stack's buffers are kept
+    // between calls, so a search allocates nothing once they have grown to
+    // its deepest line. Items added by spawn_power_ups() after a make_move()
+    // are taken back by the matching unmake_move() as well.
+    StepResult make_move(SimState &s, const SimMove *moves)
+    {
+        undo_frames.push_back(UndoFrame{int(cell_changes.size()), s.turn, s.radius, s.num_items, s.hash, s.players, s.items});
+        recording = true;
+        StepResult result = step(s, moves);
+        recording = false;
+        return result;
+    }
+
+    // Restores `s` to what it was before the latest make_move()
+    void unmake_move(SimState &s)
+    {
+        const UndoFrame &frame = undo_frames.back();
+        for (int k = int(cell_changes.size()) - 1; k >= frame.first_change; --k)
+            s.restore_cell(cell_changes[k].idx, cell_changes[k].old_cell);
+        cell_changes.resize(frame.first_change);
+        s.turn = frame.turn;
+        s.radius = frame.radius;
+        s.num_items = frame.num_items;
+        s.hash = frame.hash;
+        s.players = frame.players;
+        s.items = frame.items;
+        undo_frames.pop_back();
+    }
+
+    int undo_depth() const { return int(undo_frames.size()); }
+
+    // powerUp.addPowerUp with the caller's random source. `rng(n)` must return
+    // a uniform integer in [0, n). Call after step() reported spawn_due. Draws
+    // are made in the order CPython makes them, so a PyRandom (py_random.h)
+    // seeded like the simulator spawns the same items.
+    template <typename Rng>
+    void spawn_power_ups(SimState &s, Rng &rng)
+    {
+        char types[3] = {SPEED_BOOST_ITEM, PAINT_BOMB_ITEM, OIL_SLICK_ITEM};
+        // random.sample(types, 2): pick from the pool, refill the hole with its last element
+        int first = rng(3);
+        const char chosen_first = types[first];
+        types[first] = types[2];
+        const char chosen[2] = {chosen_first, types[rng(2)]};
+
+        int num_cells = 0;
+        for (int r = 0; r < s.grid.M; ++r)
+        {
+            for (int c = 0; c < s.grid.N; ++c)
+            {
+                int idx = s.grid.idx(r, c);
+                if (!is_unmovable_cell(s.grid[idx]))
+                    spawn_cells[num_cells++] = idx;
+            }
+        }
+
+        // Keep cells equidistant from players 0 and 1. main.py removes from the
+        // list it is iterating, so the element after every removed one survives
+        // unchecked; reproduce that.
+        int pos1 = s.num_players > 0 ? s.players[0].pos : -1;
+        int pos2 = s.num_players > 1 ? s.players[1].pos : -1;
+        int kept = 0;
+        for (int i = 0; i < num_cells; ++i)
+        {
+            int idx = spawn_cells[i];
+            if (manhattan_or_dead(s, pos1, idx) != manhattan_or_dead(s, pos2, idx))
+            {
+                if (i + 1 < num_cells)
+                    spawn_cells[kept++] = spawn_cells[++i]; // Skipped by the Python iterator
+                continue;
+            }
+            spawn_cells[kept++] = idx;
+        }
+        num_cells = kept;
+
+        for (char type : chosen)
+        {
+            if (num_cells == 0)
+                break;
+            int pick = rng(num_cells);
+            int idx = spawn_cells[pick];
+            if (s.find_item(idx) < 0 && s.add_item(idx, type, s.K))
+            {
+                for (int i = pick + 1; i < num_cells; ++i)
+                    spawn_cells[i - 1] = spawn_cells[i];
+                --num_cells;
+            }
+        }
+    }
+
+    // Destinations moveNext would accept for player i this turn, stay first.
+    // Returns how many were written to out (at most 1 + 4 + 4).
+    int legal_moves(const SimState &s, int i, SimMove *out) const
+    {
+        const SimPlayer &p = s.players[i];
+        if (!p.alive || p.pos < 0)
+            return 0;
+        const FlatGrid &g = s.grid;
+        int x = g.row_of(p.pos), y = g.col_of(p.pos);
+        int n = 0;
+        out[n++] = {x, y};
+
+        bool boost = (p.powerup == POWERUP_SPEED_BOOST && p.boost_turns > 0);
+        bool oil = (p.powerup == POWERUP_OIL_SLICK && p.oil_turns > 0);
+        const int dr[4] = {-1, 1, 0, 0};
+        const int dc[4] = {0, 0, -1, 1};
+        for (int d = 0; d < 4; ++d)
+        {
+            int one = p.pos + g.delta(dr[d], dc[d]);
+            char cell = g[one];
+            if (!is_unmovable_cell(cell) || (oil && cell == OBSTACLE_CELL))
+                out[n++] = {x + dr[d], y + dc[d]};
+            if (boost && !is_unmovable_cell(cell))
+            {
+                int two = one + g.delta(dr[d], dc[d]);
+                if (!is_unmovable_cell(g[two]))
+                    out[n++] = {x + 2 * dr[d], y + 2 * dc[d]};
+            }
+        }
+        return n;
+    }
+
+    // The turn each cell of `s` is sealed on, from s.turn on. Valid until
+    // the next call with another state.
+    const SealSchedule &seal_schedule(const SimState &s)
+    {
+        if (!seals.matches(s.grid, s.K))
+            seals.build(s.grid, s.K);
+        seals.set_turn(s.turn, s.radius, s.count_alive() > 0);
+        return seals;
+    }
+
+    // legal_moves without the ones that kill the mover at the end of this
+    // turn: landing on a ring Board.shrink seals now, or standing on '#' (oil
+    // slick) when it runs. If every move does, all of them are returned.
+    int safe_moves(const SimState &s, int i, SimMove *out)
+    {
+        int n = legal_moves(s, i, out);
+        const FlatGrid &g = s.grid;
+        bool shrinks = seal_schedule(s).shrinks_on(s.turn);
+        int kept = 0;
+        for (int a = 0; a < n; ++a)
+        {
+            int idx = g.idx(out[a].x, out[a].y);
+            if (seals.seal_turn(idx) == s.turn || (shrinks && g[idx] == OBSTACLE_CELL))
+                continue;
+            out[kept++] = out[a];
+        }
+        return kept > 0 ? kept : legal_moves(s, i, out);
+    }
+
+private:
+    struct CellChange
+    {
+        int idx;
+        char old_cell;
+    };
+
+    struct UndoFrame
+    {
+        int first_change; // Start of this move's entries in cell_changes
+        int turn, radius, num_items;
+        uint64_t hash;
+        std::array<SimPlayer, MAX_SIM_PLAYERS> players;
+        std::array<SimItem, MAX_SIM_ITEMS> items;
+    };
+
+    std::vector<CellChange> cell_changes;
+    std::vector<UndoFrame> undo_frames;
+    bool recording; // Inside make_move: log cell writes
+
+    // Every cell write of a step goes through here
+    void set_cell(SimState &s, int idx, char cell)
+    {
+        if (recording && s.grid[idx] != cell)
+            cell_changes.push_back(CellChange{idx, s.grid[idx]});
+        s.set_cell(idx, cell);
+    }
+
+    // Per-cell scratch, indexed like FlatGrid and reset through the touched lists
+    std::array<uint8_t, MAX_PADDED_CELLS> e_count;     // len(cellsAffectedByE[cell])
+    std::array<int8_t, MAX_PADDED_CELLS> e_owner;      // Last id appended there
+    std::array<uint8_t, MAX_PADDED_CELLS> boost_count; // len(cellsAffectedByTangToc[cell])
+    std::array<int8_t, MAX_PADDED_CELLS> boost_owner;
+    std::array<int, MAX_PADDED_CELLS> e_cells;
+    std::array<int, MAX_PADDED_CELLS> boost_cells;
+    int num_e_cells, num_boost_cells;
+
+    EnclosureMap enclosure;
+    EnclosureMemo fills[NUM_COLORS]; // Last fill per colour, whatever state it came from
+    SealSchedule seals;              // For safe_moves
+    BitPlane captured; // Cells that changed owner in updateCoveredArea
+    BitPlane cut_off;
+    std::array<int, MAX_PADDED_CELLS> spawn_cells;
+
+    static int alive_mask(const SimState &s)
+    {
+        int mask = 0;
+        for (int i = 0; i < s.num_players; ++i)
+            mask |= int(s.players[i].alive) << i;
+        return mask;
+    }
+
+    static void kill(SimPlayer &p)
+    {
+        p.alive = false;
+        p.pos = -1;
+    }
+
+    static int manhattan_or_dead(const SimState &s, int from, int to)
+    {
+        // Dead players sit at (-1, -1) in main.py
+        int fx = from < 0 ? -1 : s.grid.row_of(from), fy = from < 0 ? -1 : s.grid.col_of(from);
+        return std::abs(fx - s.grid.row_of(to)) + std::abs(fy - s.grid.col_of(to));
+    }
+
+    static void reset_boost(SimPlayer &p)
+    {
+        p.boost_turns = 0;
+        if (p.powerup == POWERUP_SPEED_BOOST)
+            p.powerup = POWERUP_NONE;
+    }
+
+    static void reset_oil(SimPlayer &p)
+    {
+        p.oil_turns = 0;
+        if (p.powerup == POWERUP_OIL_SLICK)
+            p.powerup = POWERUP_NONE;
+    }
+
+    // Player.moveNext
+    static void move_player(const SimState &s, SimPlayer &p, const SimMove &move)
+    {
+        if (!p.alive || p.pos < 0)
+            return;
+        const FlatGrid &g = s.grid;
+        int x = g.row_of(p.pos), y = g.col_of(p.pos);
+
+        bool oil_active = (p.powerup == POWERUP_OIL_SLICK && p.oil_turns > 0);
+        bool boost_active = (p.powerup == POWERUP_SPEED_BOOST && p.boost_turns > 0);
+        if (oil_active)
+            --p.oil_turns;
+        if (boost_active)
+            --p.boost_turns;
+
+        auto expire = [&]()
+        {
+            if (oil_active && p.oil_turns == 0)
+                reset_oil(p);
+            if (boost_active && p.boost_turns == 0)
+                reset_boost(p);
+        };
+
+        int dx = std::abs(x - move.x), dy = std::abs(y - move.y);
+        int dist = dx + dy;
+        bool inside = g.is_within_bounds(move.x, move.y);
+
+        if (dist == 0)
+        {
+            expire();
+            return;
+        }
+
+        if (oil_active && dist == 1 && inside && g.at(move.x, move.y) == OBSTACLE_CELL)
+        {
+            p.pos = g.idx(move.x, move.y);
+            reset_oil(p);
+            return;
+        }
+
+        int max_allowed_dist = 1;
+        if (boost_active)
+        {
+            max_allowed_dist = 2;
+            bool straight = (dx <= 2 && dy == 0) || (dx == 0 && dy <= 2);
+            if (!straight)
+            {
+                expire();
+                return;
+            }
+        }
+        if (dist > max_allowed_dist || !inside || is_unmovable_cell(g.at(move.x, move.y)))
+        {
+            expire();
+            return;
+        }
+
+        if (boost_active && dist == 2)
+        {
+            int mid = g.idx((x + move.x) / 2, (y + move.y) / 2);
+            if (is_unmovable_cell(g[mid]))
+            {
+                expire();
+                return;
+            }
+            p.last_mid = mid;
+        }
+        else
+        {
+            p.last_mid = -1;
+        }
+
+        p.pos = g.idx(move.x, move.y);
+        if (oil_active && p.oil_turns == 0 && p.powerup == POWERUP_OIL_SLICK)
+            reset_oil(p);
+        if (boost_active && p.boost_turns == 0 && p.powerup == POWERUP_SPEED_BOOST)
+            reset_boost(p);
+    }
+
+    // Lowest-index occupant of a cell, or -1 (cells[x][y][0] in main.py)
+    static int first_occupant(const SimState &s, const std::array<int, MAX_SIM_PLAYERS> &occupied_pos, int idx)
+    {
+        for (int i = 0; i < s.num_players; ++i)
+        {
+            if (occupied_pos[i] == idx)
+                return i;
+        }
+        return -1;
+    }
+
+    static int count_occupants(const SimState &s, const std::array<int, MAX_SIM_PLAYERS> &occupied_pos, int idx)
+    {
+        int n = 0;
+        for (int i = 0; i < s.num_players; ++i)
+            n += (occupied_pos[i] == idx);
+        return n;
+    }
+
+    void add_e_cell(int idx, int id)
+    {
+        if (e_count[idx] == 0)
+            e_cells[num_e_cells++] = idx;
+        if (e_count[idx] < 255)
+            ++e_count[idx];
+        e_owner[idx] = int8_t(id);
+    }
+
+    void add_boost_cell(int idx, int id)
+    {
+        if (boost_count[idx] == 0)
+            boost_cells[num_boost_cells++] = idx;
+        if (boost_count[idx] < 255)
+            ++boost_count[idx];
+        boost_owner[idx] = int8_t(id);
+    }
+
+    // The row-major pass over occupied cells in main.py. Only cells with
+    // exactly one occupant do anything, and each such cell belongs to one
+    // player, so visiting players in index order gives the same result.
+    void paint_occupied_cells(SimState &s, const std::array<int, MAX_SIM_PLAYERS> &occupied_pos)
+    {
+        FlatGrid &g = s.grid;
+        for (int id = 0; id < s.num_players; ++id)
+        {
+            int idx = occupied_pos[id];
+            if (idx < 0 || is_unmovable_cell(g[idx]) || count_occupants(s, occupied_pos, idx) != 1)
+                continue;
+            SimPlayer &p = s.players[id];
+            char cell = g[idx];
+            bool boosted = (p.powerup == POWERUP_SPEED_BOOST);
+
+            if (cell == EMPTY_CELL && !boosted)
+                set_cell(s, idx, p.color);
+            if (cell == 'A' || cell == 'B' || cell == 'C' || (cell == 'D' && !boosted))
+                set_cell(s, idx, p.color);
+            if (boosted)
+                add_boost_cell(idx, id);
+
+            int item = s.find_item(idx);
+            if (item < 0)
+                continue;
+            char type = s.items[item].type;
+            if (p.powerup != POWERUP_NONE)
+                continue;
+
+            if (type == SPEED_BOOST_ITEM)
+            {
+                p.boost_turns = POWERUP_DURATION;
+                p.oil_turns = 0;
+                p.powerup = POWERUP_SPEED_BOOST;
+                s.remove_item(item);
+            }
+            else if (type == PAINT_BOMB_ITEM)
+            {
+                for (int dr = -PAINT_BOMB_RADIUS; dr <= PAINT_BOMB_RADIUS; ++dr)
+                {
+                    for (int dc = -PAINT_BOMB_RADIUS; dc <= PAINT_BOMB_RADIUS; ++dc)
+                    {
+                        int target = idx + g.delta(dr, dc);
+                        if (is_unmovable_cell(g[target]))
+                            continue;
+                        int victim = first_occupant(s, occupied_pos, target);
+                        if (victim >= 0 && victim != id)
+                            kill(s.players[victim]);
+                        add_e_cell(target, id);
+                    }
+                }
+                s.remove_item(item);
+            }
+            else if (type == OIL_SLICK_ITEM)
+            {
+                p.oil_turns = POWERUP_DURATION;
+                p.boost_turns = 0;
+                p.powerup = POWERUP_OIL_SLICK;
+                s.remove_item(item);
+                set_cell(s, idx, p.color);
+            }
+        }
+    }
+
+    void apply_paint_bombs(SimState &s, const std::array<int, MAX_SIM_PLAYERS> &occupied_pos)
+    {
+        for (int k = 0; k < num_e_cells; ++k)
+        {
+            int idx = e_cells[k];
+            if (e_count[idx] == 1)
+            {
+                int id = e_owner[idx];
+                int victim = first_occupant(s, occupied_pos, idx);
+                if (victim >= 0 && victim != id)
+                    kill(s.players[victim]);
+                set_cell(s, idx, s.players[id].color);
+            }
+            e_count[idx] = 0;
+        }
+    }
+
+    void apply_speed_boost_cells(SimState &s)
+    {
+        for (int id = 0; id < s.num_players; ++id)
+        {
+            const SimPlayer &p = s.players[id];
+            if (p.alive && p.last_mid >= 0)
+                add_boost_cell(p.last_mid, id);
+        }
+        for (int k = 0; k < num_boost_cells; ++k)
+        {
+            int idx = boost_cells[k];
+            if (boost_count[idx] == 1)
+                set_cell(s, idx, s.players[boost_owner[idx]].color);
+            boost_count[idx] = 0;
+        }
+    }
+
+    // Board.updateCoveredArea followed by killing players on captured cells
+    void capture_enclosed_areas(SimState &s)
+    {
+        const FlatGrid &g = s.grid;
+        if (!enclosure.matches(g))
+            enclosure.build(g);
+        int num_words = enclosure.num_words;
+        std::fill(captured.words.begin(), captured.words.begin() + num_words, 0);
+
+        // Colours go in order and see the earlier colours' captures, which
+        // set_cell writes into s.colors; within a colour, filling a cut-off
+        // cell never cuts off another one, so the whole set can be taken at once.
+        for (int k = 0; k < s.num_players; ++k)
+        {
+            if (enclosure.captured_cells(s.colors.color[k], s.colors.blocked, cut_off, fills[k]) == 0)
+                continue;
+            char color = char('A' + k);
+            for (int w = 0; w < num_words; ++w)
+            {
+                uint64_t bits = cut_off.words[w];
+                captured.words[w] |= bits;
+                for (; bits; bits &= bits - 1)
+                    set_cell(s, w * 64 + __builtin_ctzll(bits), color);
+            }
+        }
+        for (int i = 0; i < s.num_players; ++i)
+        {
+            SimPlayer &p = s.players[i];
+            if (p.alive && p.pos >= 0 && captured.test(p.pos))
+                kill(p);
+        }
+    }
+
+    // powerUp.updatePowerUpTimeout
+    static void update_item_timeouts(SimState &s)
+    {
+        int kept = 0;
+        for (int i = 0; i < s.num_items; ++i)
+        {
+            SimItem item = s.items[i];
+            --item.timeout;
+            if (item.timeout != 0)
+                s.items[kept++] = item;
+            else
+                s.hash ^= zobrist_keys().item_key(item.pos, item.type);
+        }
+        s.num_items = kept;
+    }
+
+    // Board.shrink(radius), then kill everyone standing on an unmovable cell
+    void shrink(SimState &s)
+    {
+        FlatGrid &g = s.grid;
+        int length = s.radius;
+        auto seal = [&](int r, int c)
+        {
+            if (!g.is_within_bounds(r, c))
+                return;
+            int idx = g.idx(r, c);
+            char cell = g[idx];
+            if (cell == EMPTY_CELL)
+                set_cell(s, idx, OBSTACLE_CELL);
+            else if (cell >= 'A' && cell <= 'D')
+                set_cell(s, idx, char(cell - 'A' + 'a'));
+        };
+        for (int r = 0; r < g.M; ++r)
+        {
+            seal(r, length);
+            seal(r, g.N - 1 - length);
+        }
+        for (int c = 0; c < g.N; ++c)
+        {
+            seal(length, c);
+            seal(g.M - 1 - length, c);
+        }
+        s.set_radius(s.radius + 1);
+        for (int i = 0; i < s.num_players; ++i)
+        {
+            SimPlayer &p = s.players[i];
+            if (p.alive && (p.pos < 0 || is_unmovable_cell(g[p.pos])))
+                kill(p);
+        }
+    }
+};
@@ -0,0 +1,170 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "flat_grid.h"
+#include "forward_model.h"
+#include "seal_schedule.h"
+
+// --- Item Paths ---
+//
+// Turns until each item on the map can be picked up, from one BFS over
+// (cell, power-up, counter) with one layer per turn. Moves follow
+// ForwardModel::move_player: a speed boost allows a straight two-step over a
+// movable middle cell, an oil slick allows stepping onto an adjacent '#' (and
+// is used up by it), and both counters tick down every turn, stay or not. An
+// item is only picked up while holding nothing (paint_occupied_cells), so a
+// boosted player's route waits out the boost on the way. A landing is only
+// allowed if the cell is not sealed by the end of that turn, and an item only
+// counts while its timeout has not run out. The first arrival on an item cell
+// that picks it up ends that line, since the item is gone after it.
+
+struct ItemPathStart
+{
+    int pos;     // Flat index
+    int powerup; // PowerUpKind
+    int turns;   // Its counter as main.py keeps it (tangtoc / dautron)
+    int turn;    // Turn the first move is played on
+    int K;       // Shrink period
+};
+
+struct ItemRoute
+{
+    int turns;           // Moves up to and including the pickup, -1 if out of reach in time
+    int first_pos;       // Landing cell of the first of them
+    bool first_uses_oil; // The first move steps onto '#' with the oil slick
+};
+
+class ItemPathfinder
+{
+public:
+    // `item_pos[i]` is a flat index, -1 to skip item i. Every item can still
+    // be picked up on `item_timeout` moves, counting this turn's. `seals`
+    // must be set to start.turn.
+    void search(const FlatGrid &grid, const SealSchedule &seals, const ItemPathStart &start, const int *item_pos,
+                int num_items, int item_timeout)
+    {
+        int size = grid.padded_size();
+        routes.assign(num_items, ItemRoute{-1, -1, false});
+        item_at.assign(size, -1);
+        int last_turn = item_timeout; // No item can be picked up after this many moves
+        int remaining = 0;
+        for (int i = 0; i < num_items && item_timeout > 0; ++i)
+        {
+            if (item_pos[i] < 0 || item_at[item_pos[i]] >= 0)
+                continue;
+            item_at[item_pos[i]] = i;
+            ++remaining;
+        }
+        first_move.assign(size_t(size) * NUM_STATES, -1);
+
+        frontier.clear();
+        int start_state = encode(start.powerup, start.turns);
+        first_move[state_id(start.pos, start_state)] = 0; // Marks it visited; the value is never read
+        frontier.push_back(state_id(start.pos, start_state));
+
+        const int offsets[4] = {-grid.stride, grid.stride, -1, 1};
+        for (int t = 1; t <= last_turn && remaining > 0 && !frontier.empty(); ++t)
+        {
+            int when = start.turn + t - 1; // Turn this move is played on
+            next.clear();
+            for (int id : frontier)
+            {
+                int pos = id / NUM_STATES, state = id % NUM_STATES;
+                int kind = state_kind(state), counter = state_counter(state);
+                // Both counters tick down with every move, used or not
+                int after = (kind != POWERUP_NONE && counter > 1) ? encode(kind, counter - 1) : 0;
+                int from = (t == 1) ? -1 : first_move[id];
+
+                auto land = [&](int cell, int new_state, bool oil)
+                {
+                    if (seals.seal_turn(cell) <= when)
+                        return;
+                    if (grid[cell] == OBSTACLE_CELL && start.K > 0 && when % start.K == 0)
+                        return; // Board.shrink kills anyone left standing on '#'
+                    int next_id = state_id(cell, new_state);
+                    if (first_move[next_id] >= 0)
+                        return;
+                    int origin = from >= 0 ? from : cell * 2 + (oil ? 1 : 0);
+                    first_move[next_id] = origin;
+                    int item = item_at[cell];
+                    if (item >= 0 && new_state == 0)
+                    {
+                        if (routes[item].turns < 0)
+                        {
+                            routes[item] = ItemRoute{t, origin / 2, (origin & 1) != 0};
+                            --remaining;
+                        }
+                        return; // Picked up; nothing is held past this point on the line
+                    }
+                    next.push_back(next_id);
+                };
+
+                land(pos, after, false); // Stay
+                for (int offset : offsets)
+                {
+                    int one = pos + offset;
+                    char cell = grid[one];
+                    if (!is_unmovable_cell(cell))
+                    {
+                        land(one, after, false);
+                        if (kind == POWERUP_SPEED_BOOST)
+                        {
+                            int two = one + offset;
+                            if (!is_unmovable_cell(grid[two]))
+                                land(two, after, false);
+                        }
+                    }
+                    else if (kind == POWERUP_OIL_SLICK && cell == OBSTACLE_CELL)
+                    {
+                        land(one, 0, true);
+                    }
+                }
+            }
+            frontier.swap(next);
+        }
+    }
+
+    const ItemRoute &route(int item) const { return routes[item]; }
+
+    // Item picked up first (lowest index on ties), -1 if none is reachable
+    int nearest() const
+    {
+        int best = -1;
+        for (int i = 0; i < int(routes.size()); ++i)
+        {
+            if (routes[i].turns >= 0 && (best < 0 || routes[i].turns < routes[best].turns))
+                best = i;
+        }
+        return best;
+    }
+
+private:
+    // 0: nothing held; 1..5: speed boost with that counter; 6..10: oil slick
+    static const int NUM_STATES = 1 + 2 * POWERUP_DURATION;
+
+    std::vector<ItemRoute> routes;
+    std::vector<int> item_at;    // Flat index -> item, -1 for none
+    std::vector<int> first_move; // Per state: first landing * 2 + oil, -1 if unvisited
+    std::vector<int> frontier;
+    std::vector<int> next;
+
+    static int encode(int kind, int counter)
+    {
+        if (counter <= 0 || counter > POWERUP_DURATION)
+            return 0;
+        if (kind == POWERUP_SPEED_BOOST)
+            return counter;
+        if (kind == POWERUP_OIL_SLICK)
+            return POWERUP_DURATION + counter;
+        return 0;
+    }
+    static int state_kind(int state)
+    {
+        return state == 0 ? POWERUP_NONE : state <= POWERUP_DURATION ? POWERUP_SPEED_BOOST : POWERUP_OIL_SLICK;
+    }
+    static int state_counter(int state) { return state <= POWERUP_DURATION ? state : state - POWERUP_DURATION; }
+    static int state_id(int pos, int state) { return pos * NUM_STATES + state; }
+};
@@ -0,0 +1,259 @@
+#pragma once
+
+#include <cstdio>
+#include <istream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "flat_grid.h"
+
+// --- MAP.INP Parser ---
+//
+// Layout written by FileInteractor.writeInputFilesForPlayers:
+//   M N K turn
+//   x y color                 (this bot, -1 -1 before placement / when dead)
+//   P                         (number of other players)
+//   x y color                 (P lines)
+//   M rows of N cells         (cells may or may not be separated by spaces)
+//   item_count
+//   r c type                  (item_count lines)
+//
+// The whole file is read with a single fread and decoded in place: integers
+// and cells go straight into MapInput / the caller's FlatGrid without any
+// formatted stream in between.
+
+struct MapPlayer
+{
+    int x, y;
+    char color;
+};
+
+struct MapItem
+{
+    int r, c;
+    char type;
+};
+
+struct MapInput
+{
+    int M, N, K, turn;
+    MapPlayer me;
+    std::vector<MapPlayer> others;
+    std::vector<MapItem> items;
+
+    MapInput() : M(0), N(0), K(0), turn(0), me{-1, -1, ' '} {}
+};
+
+class MapTextCursor
+{
+public:
+    MapTextCursor(const char *begin, const char *end) : p(begin), end(end) {}
+
+    bool next_int(int &value)
+    {
+        skip_spaces();
+        bool negative = false;
+        if (p < end && (*p == '-' || *p == '+'))
+        {
+            negative = (*p == '-');
+            ++p;
+        }
+        if (p >= end || *p < '0' || *p > '9')
+            return false;
+        long long v = 0;
+        while (p < end && *p >= '0' && *p <= '9')
+        {
+            v = v * 10 + (*p - '0');
+            if (v > 1000000000LL)
+                return false;
+            ++p;
+        }
+        value = int(negative ? -v : v);
+        return true;
+    }
+
+    bool next_char(char &value)
+    {
+        skip_spaces();
+        if (p >= end)
+            return false;
+        value = *p++;
+        return true;
+    }
+
+private:
+    const char *p;
+    const char *end;
+
+    void skip_spaces()
+    {
+        while (p < end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t'))
+            ++p;
+    }
+};
+
+inline bool is_map_cell(char cell)
+{
+    return cell == EMPTY_CELL || cell == OBSTACLE_CELL || (cell >= 'A' && cell <= 'D') || is_sealed_cell(cell);
+}
+
+inline bool is_player_color(char color)
+{
+    return color >= 'A' && color <= 'D';
+}
+
+inline bool is_item_type(char type)
+{
+    return type == SPEED_BOOST_ITEM || type == PAINT_BOMB_ITEM || type == OIL_SLICK_ITEM;
+}
+
+inline bool map_parse_fail(std::string *error, const std::string &message)
+{
+    if (error)
+        *error = message;
+    return false;
+}
+
+// Players are either off the board (-1 -1) or on it
+inline bool is_valid_player_position(const MapInput &input, const MapPlayer &player)
+{
+    if (player.x == -1 && player.y == -1)
+        return true;
+    return player.x >= 0 && player.x < input.M && player.y >= 0 && player.y < input.N;
+}
+
+inline bool read_player(MapTextCursor &cursor, const MapInput &input, MapPlayer &player, std::string *error)
+{
+    if (!cursor.next_int(player.x) || !cursor.next_int(player.y) || !cursor.next_char(player.color))
+        return map_parse_fail(error, "truncated player line");
+    if (!is_player_color(player.color))
+        return map_parse_fail(error, std::string("bad player colour '") + player.color + "'");
+    if (!is_valid_player_position(input, player))
+        return map_parse_fail(error, "player position " + std::to_string(player.x) + " " + std::to_string(player.y) + " is off the board");
+    return true;
+}
+
+// Parses [begin, end) into `input`, writing the cells directly into `grid`
+inline bool parse_map_text(const char *begin, const char *end, MapInput &input, FlatGrid &grid, std::string *error = nullptr)
+{
+    MapTextCursor cursor(begin, end);
+
+    if (!cursor.next_int(input.M) || !cursor.next_int(input.N) || !cursor.next_int(input.K) || !cursor.next_int(input.turn))
+        return map_parse_fail(error, "truncated header");
+    if (input.M <= 0 || input.N <= 0 || input.M > MAX_BOARD_DIM || input.N > MAX_BOARD_DIM)
+        return map_parse_fail(error, "board " + std::to_string(input.M) + "x" + std::to_string(input.N) + " is outside 1.." + std::to_string(MAX_BOARD_DIM));
+    if (input.K < 0 || input.turn < 0)
+        return map_parse_fail(error, "negative shrink period or turn");
+
+    if (!read_player(cursor, input, input.me, error))
+        return false;
+
+    int num_other_players;
+    if (!cursor.next_int(num_other_players))
+        return map_parse_fail(error, "missing player count");
+    if (num_other_players < 0 || num_other_players >= 4)
+        return map_parse_fail(error, "bad player count " + std::to_string(num_other_players));
+    input.others.resize(num_other_players);
+    for (MapPlayer &player : input.others)
+    {
+        if (!read_player(cursor, input, player, error))
+            return false;
+    }
+
+    grid.reset(input.M, input.N);
+    for (int r = 0; r < input.M; ++r)
+    {
+        char *row = &grid.cells[grid.idx(r, 0)];
+        for (int c = 0; c < input.N; ++c)
+        {
+            if (!cursor.next_char(row[c]))
+                return map_parse_fail(error, "grid ends at row " + std::to_string(r));
+            if (!is_map_cell(row[c]))
+                return map_parse_fail(error, std::string("bad cell '") + row[c] + "' at " + std::to_string(r) + " " + std::to_string(c));
+        }
+    }
+
+    int num_items;
+    if (!cursor.next_int(num_items))
+        return map_parse_fail(error, "missing item count");
+    if (num_items < 0 || num_items > input.M * input.N)
+        return map_parse_fail(error, "bad item count " + std::to_string(num_items));
+    input.items.resize(num_items);
+    for (MapItem &item : input.items)
+    {
+        if (!cursor.next_int(item.r) || !cursor.next_int(item.c) || !cursor.next_char(item.type))
+            return map_parse_fail(error, "truncated item line");
+        if (item.r < 0 || item.r >= input.M || item.c < 0 || item.c >= input.N)
+            return map_parse_fail(error, "item at " + std::to_string(item.r) + " " + std::to_string(item.c) + " is off the board");
+        if (!is_item_type(item.type))
+            return map_parse_fail(error, std::string("bad item type '") + item.type + "'");
+    }
+    return true;
+}
+
+// Slurps the whole file into `buffer` with one read
+inline bool read_whole_file(const std::string &filename, std::string &buffer)
+{
+    std::FILE *file = std::fopen(filename.c_str(), "rb");
+    if (!file)
+        return false;
+    std::fseek(file, 0, SEEK_END);
+    long size = std::ftell(file);
+    std::fseek(file, 0, SEEK_SET);
+    buffer.resize(size > 0 ? size_t(size) : 0);
+    size_t got = buffer.empty() ? 0 : std::fread(&buffer[0], 1, buffer.size(), file);
+    std::fclose(file);
+    buffer.resize(got);
+    return true;
+}
+
+inline bool parse_map_file(const std::string &filename, MapInput &input, FlatGrid &grid, std::string *error = nullptr)
+{
+    std::string buffer;
+    if (!read_whole_file(filename, buffer))
+        return map_parse_fail(error, "could not open " + filename);
+    return parse_map_text(buffer.data(), buffer.data() + buffer.size(), input, grid, error);
+}
+
+// Reads one MAP.INP-formatted turn from a stream into `block`, line by line,
+// using the counts in the text itself to know where the turn ends. Blank lines
+// between turns are skipped. Returns false on EOF or a "QUIT" line; a turn cut
+// short by EOF is still returned so that parse_map_text reports it.
+inline bool read_map_block(std::istream &in, std::string &block)
+{
+    std::string line;
+    block.clear();
+    do
+    {
+        if (!std::getline(in, line))
+            return false;
+    } while (line.find_first_not_of(" \t\r") == std::string::npos);
+    if (line.compare(0, 4, "QUIT") == 0)
+        return false;
+
+    auto take_lines = [&](int count)
+    {
+        for (int i = 0; i < count; ++i)
+        {
+            if (!std::getline(in, line))
+                return false;
+            block += line;
+            block += '\n';
+        }
+        return true;
+    };
+
+    int M = 0, num_other_players = 0, num_items = 0;
+    std::istringstream(line) >> M;
+    block += line;
+    block += '\n';
+    if (!take_lines(2)) // Own player, then the other-player count
+        return true;
+    std::istringstream(line) >> num_other_players;
+    if (!take_lines(std::max(num_other_players, 0) + std::max(M, 0) + 1)) // Players, grid, item count
+        return true;
+    std::istringstream(line) >> num_items;
+    take_lines(std::max(num_items, 0));
+    return true;
+}
@@ -0,0 +1,628 @@
+#pragma once
+
+#if defined(_WIN32)
+#error "match.h hosts bots with dlopen and fork; build the arena on Linux, macOS or WSL"
+#endif
+
+#include <dlfcn.h>
+#include <fcntl.h>
+#include <ftw.h>
+#include <signal.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <climits>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bot_api.h"
+#include "forward_model.h"
+#include "map_parser.h"
+#include "py_random.h"
+
+// --- Match Runner ---
+//
+// Plays whole games of Simulator/main.py without the simulator: the rules are
+// ForwardModel's, every random draw main.py makes goes through a PyRandom in
+// the same order, so a game played with seed n here is the game
+// `python main.py <map> -p ... --seed n` plays with the same deterministic
+// bots. Nothing is written to the shared Players/ folders, so any number of
+// games can run at once.
+//
+// A player is either a plugin library (bot_api.h), played in-process, or an
+// executable run once per turn like the simulator runs main.exe, in a
+// directory of its own per game. POSIX only: libraries are loaded with dlopen
+// and executables started with fork/exec.
+
+// --- Maps ---
+
+// A Simulator/Map file: "M N K", then M rows of cells, spaced or not
+struct MatchMap
+{
+    std::string name; // File name, as given to main.py
+    int M, N, K;
+    std::vector<std::string> rows;
+};
+
+inline std::string base_name(const std::string &path)
+{
+    size_t slash = path.find_last_of('/');
+    return slash == std::string::npos ? path : path.substr(slash + 1);
+}
+
+inline bool load_match_map(const std::string &filename, MatchMap &map, std::string *error = nullptr)
+{
+    std::string text;
+    if (!read_whole_file(filename, text))
+        return map_parse_fail(error, "could not open " + filename);
+    map.name = base_name(filename);
+    map.rows.clear();
+
+    MapTextCursor cursor(text.data(), text.data() + text.size());
+    if (!cursor.next_int(map.M) || !cursor.next_int(map.N) || !cursor.next_int(map.K))
+        return map_parse_fail(error, filename + ": truncated header");
+    if (map.M <= 0 || map.N <= 0 || map.M > MAX_BOARD_DIM || map.N > MAX_BOARD_DIM || map.K <= 0)
+        return map_parse_fail(error, filename + ": bad header");
+    for (int r = 0; r < map.M; ++r)
+    {
+        std::string row(size_t(map.N), EMPTY_CELL);
+        for (int c = 0; c < map.N; ++c)
+        {
+            if (!cursor.next_char(row[c]))
+                return map_parse_fail(error, filename + ": grid ends at row " + std::to_string(r));
+            if (!is_map_cell(row[c]))
+                return map_parse_fail(error, filename + ": bad cell '" + row[c] + "'");
+        }
+        map.rows.push_back(row);
+    }
+    return true;
+}
+
+// Turn 0 before anyone answered: the map, with every player still off the board
+inline void start_match(const MatchMap &map, int num_players, SimState &s)
+{
+    s = SimState();
+    s.grid.reset(map.M, map.N);
+    for (int r = 0; r < map.M; ++r)
+    {
+        for (int c = 0; c < map.N; ++c)
+            s.grid.at(r, c) = map.rows[r][c];
+    }
+    s.K = map.K;
+    s.num_players = num_players;
+    for (int i = 0; i < MAX_SIM_PLAYERS; ++i)
+        s.players[i] = {-1, i < num_players, char('A' + i), 0, 0, POWERUP_NONE, -1};
+    s.rehash();
+}
+
+// --- Turn Text ---
+
+// FileInteractor.writeInputFilesForPlayers for player `seat`
+inline void format_map_input(const SimState &s, int seat, std::string &out)
+{
+    const FlatGrid &g = s.grid;
+    out.clear();
+    auto append_player = [&](int i)
+    {
+        const SimPlayer &p = s.players[i];
+        bool on_board = p.alive && p.pos >= 0;
+        out += std::to_string(on_board ? g.row_of(p.pos) : -1);
+        out += ' ';
+        out += std::to_string(on_board ? g.col_of(p.pos) : -1);
+        out += ' ';
+        out += char('A' + i);
+        out += '\n';
+    };
+
+    out += std::to_string(g.M) + ' ' + std::to_string(g.N) + ' ' + std::to_string(s.K) + ' ' + std::to_string(s.turn) + '\n';
+    append_player(seat);
+    out += std::to_string(s.num_players - 1) + '\n';
+    for (int i = 0; i < s.num_players; ++i)
+    {
+        if (i != seat)
+            append_player(i);
+    }
+    for (int r = 0; r < g.M; ++r)
+    {
+        for (int c = 0; c < g.N; ++c)
+        {
+            out += g.at(r, c);
+            out += c + 1 < g.N ? ' ' : '\n';
+        }
+    }
+    out += std::to_string(s.num_items) + '\n';
+    for (int k = 0; k < s.num_items; ++k)
+    {
+        const SimItem &item = s.items[k];
+        out += std::to_string(g.row_of(item.pos)) + ' ' + std::to_string(g.col_of(item.pos)) + ' ' + item.type + '\n';
+    }
+}
+
+// FileInteractor.readOutputFilesOfPlayers: the first line minus its last
+// character, split on single spaces. Anything that does not make exactly two
+// integers out of that is (-1, -1), as a missing file is.
+inline SimMove parse_move_output(const std::string &text)
+{
+    size_t newline = text.find('\n');
+    std::string line = text.substr(0, newline == std::string::npos ? text.size() : newline + 1);
+    if (!line.empty())
+        line.pop_back();
+    std::vector<std::string> fields;
+    size_t start = 0;
+    for (size_t space; (space = line.find(' ', start)) != std::string::npos; start = space + 1)
+        fields.push_back(line.substr(start, space - start));
+    fields.push_back(line.substr(start));
+
+    int values[2];
+    if (fields.size() != 2)
+        return {-1, -1};
+    for (int k = 0; k < 2; ++k)
+    {
+        // int() accepts surrounding whitespace and a sign, nothing else
+        const char *p = fields[k].c_str();
+        char *end = nullptr;
+        errno = 0;
+        long v = std::strtol(p, &end, 10);
+        while (*end == ' ' || *end == '\t' || *end == '\r')
+            ++end;
+        if (end == p || *end != '\0' || errno != 0)
+            return {-1, -1};
+        values[k] = int(v);
+    }
+    return {values[0], values[1]};
+}
+
+// --- Players ---
+
+enum PlayerKind
+{
+    PLAYER_LIBRARY, // Built with -DBOT_LIBRARY, played in-process
+    PLAYER_PROCESS  // An executable run once per turn, like main.exe
+};
+
+struct PlayerSpec
+{
+    std::string label;   // How results name this player
+    PlayerKind kind;
+    std::string path;    // Absolute
+    std::string options; // bot_create options, or the executable's arguments
+};
+
+// "[label=][lib:|exe:]path[ options...]". Without a prefix, a path ending in
+// .so or .dylib is a library and anything else an executable.
+inline bool parse_player_spec(const std::string &text, PlayerSpec &spec, std::string *error = nullptr)
+{
+    std::string rest = text;
+    spec.label.clear();
+    size_t equals = rest.find('=');
+    if (equals != std::string::npos && rest.find_first_of("/: ") > equals)
+    {
+        spec.label = rest.substr(0, equals);
+        rest = rest.substr(equals + 1);
+    }
+
+    size_t space = rest.find(' ');
+    std::string path = rest.substr(0, space);
+    size_t options = space == std::string::npos ? std::string::npos : rest.find_first_not_of(' ', space);
+    spec.options = options == std::string::npos ? std::string() : rest.substr(options);
+    auto ends_with = [&](const char *suffix)
+    {
+        size_t n = std::strlen(suffix);
+        return path.size() >= n && path.compare(path.size() - n, n, suffix) == 0;
+    };
+    if (path.compare(0, 4, "lib:") == 0)
+    {
+        spec.kind = PLAYER_LIBRARY;
+        path = path.substr(4);
+    }
+    else if (path.compare(0, 4, "exe:") == 0)
+    {
+        spec.kind = PLAYER_PROCESS;
+        path = path.substr(4);
+    }
+    else
+    {
+        spec.kind = ends_with(".so") || ends_with(".dylib") ? PLAYER_LIBRARY : PLAYER_PROCESS;
+    }
+
+    char resolved[PATH_MAX];
+    if (path.empty() || !realpath(path.c_str(), resolved))
+        return map_parse_fail(error, "player " + text + ": cannot find " + path);
+    spec.path = resolved;
+
+    if (spec.label.empty())
+    {
+        // main.exe is named after its folder, as in Simulator/Players/<name>/
+        std::string file = base_name(spec.path);
+        std::string stem = file.substr(0, file.find('.'));
+        if (stem == "main")
+        {
+            std::string folder = spec.path.substr(0, spec.path.size() - file.size() - 1);
+            stem = base_name(folder);
+        }
+        else if (spec.kind == PLAYER_LIBRARY && stem.compare(0, 3, "lib") == 0 && stem.size() > 3)
+        {
+            stem = stem.substr(3);
+        }
+        spec.label = spec.options.empty() ? stem : stem + " " + spec.options;
+    }
+    return true;
+}
+
+inline bool make_directories(const std::string &path)
+{
+    for (size_t slash = path.find('/', 1);; slash = path.find('/', slash + 1))
+    {
+        std::string prefix = path.substr(0, slash);
+        if (mkdir(prefix.c_str(), 0755) != 0 && errno != EEXIST)
+            return false;
+        if (slash == std::string::npos)
+            return true;
+    }
+}
+
+inline bool copy_file(const std::string &from, const std::string &to)
+{
+    std::string bytes;
+    if (!read_whole_file(from, bytes))
+        return false;
+    std::FILE *file = std::fopen(to.c_str(), "wb");
+    if (!file)
+        return false;
+    bool ok = std::fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size();
+    return std::fclose(file) == 0 && ok;
+}
+
+inline bool write_file(const std::string &filename, const std::string &text)
+{
+    std::FILE *file = std::fopen(filename.c_str(), "wb");
+    if (!file)
+        return false;
+    bool ok = std::fwrite(text.data(), 1, text.size(), file) == text.size();
+    return std::fclose(file) == 0 && ok;
+}
+
+inline void remove_directory_tree(const std::string &path)
+{
+    auto remove_entry = [](const char *file, const struct stat *, int, struct FTW *)
+    {
+        std::remove(file);
+        return 0;
+    };
+    nftw(path.c_str(), remove_entry, 16, FTW_DEPTH | FTW_PHYS);
+}
+
+// One loaded plugin. Bots may keep state in globals (OnlyUp, OnlyDown), so
+// every thread that plays games loads its own copy of the file: dlopen
+// shares one image between all loads of the same file.
+class BotLibrary
+{
+public:
+    BotCreateFn create = nullptr;
+    BotInitFn init = nullptr;
+    BotDecideFn decide = nullptr;
+    BotResetFn reset = nullptr;
+    BotDestroyFn destroy = nullptr;
+    BotWeightsFn weights = nullptr; // Optional, nullptr if the bot has none
+
+    BotLibrary() = default;
+    BotLibrary(const BotLibrary &) = delete;
+    BotLibrary &operator=(const BotLibrary &) = delete;
+
+    ~BotLibrary()
+    {
+        if (handle)
+            dlclose(handle);
+    }
+
+    // Loads a private copy of `path`, made at `copy_path`
+    bool load(const std::string &path, const std::string &copy_path, std::string *error = nullptr)
+    {
+        if (!copy_file(path, copy_path))
+            return map_parse_fail(error, "cannot copy " + path + " to " + copy_path);
+        handle = dlopen(copy_path.c_str(), RTLD_NOW | RTLD_LOCAL);
+        if (!handle)
+            return map_parse_fail(error, dlerror());
+        BotApiVersionFn version = (BotApiVersionFn)dlsym(handle, "bot_api_version");
+        create = (BotCreateFn)dlsym(handle, "bot_create");
+        init = (BotInitFn)dlsym(handle, "bot_init");
+        decide = (BotDecideFn)dlsym(handle, "bot_decide");
+        reset = (BotResetFn)dlsym(handle, "bot_reset");
+        destroy = (BotDestroyFn)dlsym(handle, "bot_destroy");
+        weights = (BotWeightsFn)dlsym(handle, "bot_weights");
+        if (!version || !create || !init || !decide || !reset || !destroy)
+            return map_parse_fail(error, path + " does not export the bot_api.h functions (built without -DBOT_LIBRARY?)");
+        if (version() != BOT_API_VERSION)
+            return map_parse_fail(error, path + " was built for bot API version " + std::to_string(version()));
+        return true;
+    }
+
+private:
+    void *handle = nullptr;
+};
+
+// One player's side of one game
+class MatchSeat
+{
+public:
+    // In-process, on an instance of `library`
+    MatchSeat(BotLibrary &library, const std::string &options) : library(&library), bot(library.create(options.c_str())) {}
+
+    // main.exe-style in `directory`, which the seat creates and removes. A
+    // turn that runs past timeout_ms is killed, as the simulator does.
+    MatchSeat(const PlayerSpec &spec, const std::string &directory, int timeout_ms, bool keep_directory)
+        : library(nullptr), bot(nullptr), directory(directory), timeout_ms(timeout_ms), keep_directory(keep_directory)
+    {
+        arguments.push_back(spec.path);
+        size_t start = spec.options.find_first_not_of(' ');
+        while (start != std::string::npos)
+        {
+            size_t end = spec.options.find(' ', start);
+            arguments.push_back(spec.options.substr(start, end - start));
+            start = spec.options.find_first_not_of(' ', end);
+        }
+    }
+
+    ~MatchSeat()
+    {
+        if (bot)
+            library->destroy(bot);
+        if (!library && !keep_directory && !directory.empty())
+            remove_directory_tree(directory);
+    }
+
+    MatchSeat(const MatchSeat &) = delete;
+    MatchSeat &operator=(const MatchSeat &) = delete;
+
+    // Called with the turn-0 text before the first decide()
+    bool new_game(const std::string &map_text)
+    {
+        if (library)
+            return bot && library->init(bot, map_text.data(), map_text.size()) == 0;
+        return make_directories(directory);
+    }
+
+    SimMove decide(const std::string &map_text)
+    {
+        if (library)
+        {
+            SimMove move = {-1, -1};
+            if (bot)
+                library->decide(bot, map_text.data(), map_text.size(), &move.x, &move.y);
+            return move;
+        }
+        // MOVE.OUT and STATE.DAT stay between turns: a bot that fails to
+        // write a move plays its previous one again
+        write_file(directory + "/MAP.INP", map_text);
+        run_process();
+        std::string text;
+        return read_whole_file(directory + "/MOVE.OUT", text) ? parse_move_output(text) : SimMove{-1, -1};
+    }
+
+private:
+    BotLibrary *library;
+    BotInstance *bot;
+    std::string directory;
+    std::vector<std::string> arguments;
+    int timeout_ms = 0;
+    bool keep_directory = false;
+
+    void run_process()
+    {
+        std::vector<char *> argv;
+        for (std::string &arg : arguments)
+            argv.push_back(&arg[0]);
+        argv.push_back(nullptr);
+        std::string log = directory + "/log.txt";
+
+        pid_t pid = fork();
+        if (pid < 0)
+            return;
+        if (pid == 0)
+        {
+            // Only async-signal-safe calls between fork and exec
+            setpgid(0, 0);
+            if (chdir(directory.c_str()) != 0)
+                _exit(127);
+            int out = open(log.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+            if (out >= 0)
+            {
+                dup2(out, STDOUT_FILENO);
+                dup2(out, STDERR_FILENO);
+                close(out);
+            }
+            execv(argv[0], argv.data());
+            _exit(127);
+        }
+        setpgid(pid, pid); // Also from here, in case the child has not run yet
+
+        std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+        int pause_us = 50;
+        int status;
+        while (waitpid(pid, &status, WNOHANG) == 0)
+        {
+            if (std::chrono::steady_clock::now() >= deadline)
+            {
+                kill(-pid, SIGKILL); // The whole group, like the simulator's psutil sweep
+                waitpid(pid, &status, 0);
+                return;
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(pause_us));
+            pause_us = std::min(pause_us * 2, 2000);
+        }
+    }
+};
+
+// --- Game Loop ---
+
+struct MatchResult
+{
+    int num_players;
+    int turns; // main.py's `turn` when the game stopped
+    std::array<int, MAX_SIM_PLAYERS> area;       // Board.findColoredArea at the end
+    std::array<int, MAX_SIM_PLAYERS> death_turn; // The turn a player died on; the board seals everyone in the end
+};
+
+// main.py's loop, seat i playing colour 'A' + i. Only live players are asked
+// for a move. The draws match main.py's with random.seed(seed): the shuffle
+// of movable cells and a randint per unplaced player on turn 0, then
+// random.sample and random.choice in every addPowerUp. With `starts`, seat i
+// is placed on starts[i] whatever it answers on turn 0, unless starts[i].x is
+// negative; Source/opening_book tries starting cells that way.
+inline MatchResult play_match(const MatchMap &map, const std::vector<MatchSeat *> &seats, uint64_t seed, ForwardModel &model,
+                              const SimMove *starts = nullptr)
+{
+    int num_players = std::min(int(seats.size()), MAX_SIM_PLAYERS);
+    PyRandom rng(seed);
+    SimState s;
+    start_match(map, num_players, s);
+    std::string text;
+    for (int i = 0; i < num_players; ++i)
+    {
+        format_map_input(s, i, text);
+        seats[i]->new_game(text);
+    }
+
+    SimMove moves[MAX_SIM_PLAYERS];
+    std::array<int, MAX_SIM_PLAYERS> death_turn;
+    death_turn.fill(-1);
+    for (;;)
+    {
+        for (int i = 0; i < num_players; ++i)
+        {
+            moves[i] = {-1, -1};
+            if (!s.players[i].alive)
+                continue;
+            format_map_input(s, i, text);
+            moves[i] = seats[i]->decide(text);
+            if (s.turn == 0 && starts && starts[i].x >= 0)
+                moves[i] = starts[i];
+        }
+
+        if (s.turn == 0)
+        {
+            // ListOfPlayers.chooseStartingPositions
+            std::vector<int> cells;
+            for (int r = 0; r < s.grid.M; ++r)
+            {
+                for (int c = 0; c < s.grid.N; ++c)
+                {
+                    if (!is_unmovable_cell(s.grid.at(r, c)))
+                        cells.push_back(s.grid.idx(r, c));
+                }
+            }
+            rng.shuffle(cells);
+            int fallback_cells[MAX_SIM_PLAYERS] = {-1, -1, -1, -1};
+            for (int i = 0; i < num_players; ++i)
+            {
+                bool movable = s.grid.is_within_bounds(moves[i].x, moves[i].y) && !is_unmovable_cell(s.grid.at(moves[i].x, moves[i].y));
+                if (!movable && !cells.empty())
+                    fallback_cells[i] = cells[rng.randint(0, int(cells.size()) - 1)];
+            }
+            model.place_players(s, moves, fallback_cells);
+        }
+
+        StepResult step = model.step(s, moves);
+        for (int i = 0; i < num_players; ++i)
+        {
+            if (step.killed_mask & (1 << i))
+                death_turn[i] = s.turn - 1;
+        }
+        if (step.spawn_due)
+            model.spawn_power_ups(s, rng);
+        if (s.is_game_over())
+            break;
+    }
+
+    MatchResult result;
+    result.num_players = num_players;
+    result.turns = s.turn;
+    result.area.fill(0);
+    result.death_turn = death_turn;
+    for (int i = 0; i < num_players; ++i)
+        result.area[i] = s.area_of(i);
+    return result;
+}
+
+// Which seats finished with the largest area: 1 if that is seat `seat` alone,
+// 0.5 if it shares it, 0 otherwise
+inline double match_score(const MatchResult &result, int seat)
+{
+    int best = *std::max_element(result.area.begin(), result.area.begin() + result.num_players);
+    int leaders = int(std::count(result.area.begin(), result.area.begin() + result.num_players, best));
+    if (result.area[seat] < best)
+        return 0.0;
+    return leaders > 1 ? 0.5 : 1.0;
+}
+
+// --- Workers ---
+
+// What one thread needs to play games: a forward model, and its own copy of
+// every library player, loaded the first time that player sits down. Players
+// are known by their index in the caller's list.
+class MatchWorker
+{
+public:
+    // Library copies and the folders of executable players go under `directory`
+    MatchWorker(const std::string &directory, int timeout_ms, bool keep_dirs)
+        : directory(directory), timeout_ms(timeout_ms), keep_dirs(keep_dirs)
+    {
+    }
+
+    // Plays one game with players[seating[i]] as colour 'A' + i. Folders for
+    // the game are named after `game_name`. `starts` is play_match's.
+    bool play(const MatchMap &map, const std::vector<PlayerSpec> &players, const std::vector<int> &seating, uint64_t seed,
+              const std::string &game_name, MatchResult &result, std::string *error = nullptr, const SimMove *starts = nullptr)
+    {
+        if (!make_directories(directory))
+            return map_parse_fail(error, "cannot create " + directory);
+        libraries.resize(std::max(libraries.size(), players.size()));
+        std::vector<std::unique_ptr<MatchSeat>> seats;
+        std::vector<MatchSeat *> seat_pointers;
+        for (size_t i = 0; i < seating.size(); ++i)
+        {
+            int p = seating[i];
+            const PlayerSpec &spec = players[p];
+            if (spec.kind == PLAYER_PROCESS)
+            {
+                std::string seat_directory = directory + "/" + game_name + "/" + char('A' + i);
+                seats.emplace_back(new MatchSeat(spec, seat_directory, timeout_ms, keep_dirs));
+            }
+            else
+            {
+                if (!libraries[p])
+                {
+                    std::unique_ptr<BotLibrary> library(new BotLibrary());
+                    if (!library->load(spec.path, directory + "/player" + std::to_string(p) + ".so", error))
+                        return false;
+                    libraries[p] = std::move(library);
+                }
+                seats.emplace_back(new MatchSeat(*libraries[p], spec.options));
+            }
+            seat_pointers.push_back(seats.back().get());
+        }
+        result = play_match(map, seat_pointers, seed, model, starts);
+        seats.clear();
+        if (!keep_dirs)
+            remove_directory_tree(directory + "/" + game_name);
+        return true;
+    }
+
+private:
+    std::string directory;
+    int timeout_ms;
+    bool keep_dirs;
+    ForwardModel model;
+    std::vector<std::unique_ptr<BotLibrary>> libraries;
+};
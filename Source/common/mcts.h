@@ -0,0 +1,376 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "forward_model.h"
+#include "opponent_model.h"
+#include "search_common.h"
+
+// --- Monte Carlo Tree Search ---
+//
+// Anytime decoupled UCT over the forward model. All turns are simultaneous, so
+// every node keeps separate UCB statistics per player and per move; each
+// player picks its own move by UCB1 and the joint move selects the child. The
+// tree stores no states: each iteration replays its path from the root state
+// (open loop), which is exact here because step() is deterministic once power-up
+// spawning is left out. Playouts pick moves with score_move (see
+// search_common.h) and are scored by area and survival. Given an
+// OpponentModel, opponents play its predicted moves in playouts instead, and
+// a node leaves out the moves it is confident they will not make.
+
+struct MctsConfig
+{
+    double exploration = 0.6;   // UCB1 constant; rewards are in [0, 1]
+    int horizon = 12;           // Turns simulated past the root (tree + playout)
+    double random_moves = 0.2;  // Chance a playout move is uniform instead of greedy
+    int max_nodes = 1 << 15;    // The tree stops growing here (~600 bytes a node); playouts go on
+    int progress_ms = 100;      // How often on_progress hears about the current best move
+    double prior_cutoff = 0.05; // Opponent moves a confident prediction gives less are not in the tree
+    uint64_t seed = 0x9E3779B97F4A7C15ULL;
+};
+
+struct MctsResult
+{
+    bool found;     // false if there was no time for a single iteration
+    SimMove move;   // Most visited root move of the searching player
+    int iterations;
+    int visits;     // Visits of that move
+    double value;   // Its mean reward
+};
+
+class MctsSearch
+{
+public:
+    static const int MAX_TREE_DEPTH = 256;
+
+    MctsConfig config;
+    MoveWeights weights;
+    const OpponentModel *opponents = nullptr; // Optional; see opponent_model.h
+    // Called during the search with the best root move so far, e.g. to
+    // publish it before the deadline
+    std::function<void(const MctsResult &)> on_progress;
+
+    MctsSearch() : rng_state(config.seed) { nodes.reserve(4096); }
+
+    // Independent trees searching the same root need different seeds
+    void set_seed(uint64_t seed)
+    {
+        config.seed = seed;
+        rng_state = seed;
+    }
+
+    // Searches from `root` for player `me` until `deadline`
+    MctsResult search(const SimState &root, int me, SearchClock::time_point deadline)
+    {
+        MctsResult result = {false, {-1, -1}, 0, 0, 0.0};
+        if (me < 0 || me >= root.num_players || !root.players[me].alive)
+            return result;
+        if (rng_state == 0)
+            rng_state = config.seed;
+
+        searcher = me;
+        for (int i = 0; i < MAX_SIM_PLAYERS; ++i)
+            root_previous[i] = opponents ? opponents->previous_position(i) : -1;
+        nodes.clear();
+        new_node(root, root_previous);
+        const int horizon_turn = root.turn + config.horizon;
+
+        int iterations = 0;
+        SearchClock::time_point next_progress = SearchClock::now() + std::chrono::milliseconds(config.progress_ms);
+        for (SearchClock::time_point now = SearchClock::now(); now < deadline; now = SearchClock::now())
+        {
+            run_iteration(root, horizon_turn);
+            ++iterations;
+            if (on_progress && now >= next_progress)
+            {
+                on_progress(root_result(me, iterations));
+                next_progress = now + std::chrono::milliseconds(config.progress_ms);
+            }
+        }
+        return root_result(me, iterations);
+    }
+
+    int tree_size() const { return int(nodes.size()); }
+
+    // Root statistics of player `me` from the last search, in safe_moves
+    // order; lets root-parallel callers add up several independent trees.
+    // Returns the number of moves.
+    int root_stats(int me, SimMove *moves, uint32_t *visits, double *value_sum) const
+    {
+        if (nodes.empty())
+            return 0;
+        const Node &top = nodes[0];
+        for (int a = 0; a < top.num_moves[me]; ++a)
+        {
+            moves[a] = top.moves[me][a];
+            visits[a] = top.visits[me][a];
+            value_sum[a] = top.value_sum[me][a];
+        }
+        return top.num_moves[me];
+    }
+
+private:
+    struct Node
+    {
+        uint8_t num_moves[MAX_SIM_PLAYERS];
+        SimMove moves[MAX_SIM_PLAYERS][MAX_SIM_MOVES];
+        uint32_t visits[MAX_SIM_PLAYERS][MAX_SIM_MOVES];
+        float value_sum[MAX_SIM_PLAYERS][MAX_SIM_MOVES];
+        uint32_t total_visits;
+        uint32_t joint;   // Joint move index leading here from the parent
+        int first_child;
+        int next_sibling;
+    };
+
+    struct PathStep
+    {
+        int node;
+        uint8_t choice[MAX_SIM_PLAYERS];
+    };
+
+    std::vector<Node> nodes;
+    ForwardModel model;
+    PathStep path[MAX_TREE_DEPTH];
+    uint64_t rng_state;
+    int searcher = 0;
+    int root_previous[MAX_SIM_PLAYERS]; // Positions a turn before the root, for the opponent model
+
+    uint64_t next_random()
+    {
+        // xorshift64*
+        rng_state ^= rng_state >> 12;
+        rng_state ^= rng_state << 25;
+        rng_state ^= rng_state >> 27;
+        return rng_state * 0x2545F4914F6CDD1DULL;
+    }
+
+    int random_below(int n) { return int((next_random() >> 33) % uint64_t(n)); }
+    double random_unit() { return double(next_random() >> 11) * (1.0 / 9007199254740992.0); }
+
+    MctsResult root_result(int me, int iterations) const
+    {
+        MctsResult result = {false, {-1, -1}, iterations, 0, 0.0};
+        const Node &top = nodes[0];
+        int best = -1;
+        for (int a = 0; a < top.num_moves[me]; ++a)
+        {
+            if (best < 0 || top.visits[me][a] > top.visits[me][best])
+                best = a;
+        }
+        if (best < 0 || top.visits[me][best] == 0)
+            return result;
+        result.found = true;
+        result.move = top.moves[me][best];
+        result.visits = int(top.visits[me][best]);
+        result.value = top.value_sum[me][best] / top.visits[me][best];
+        return result;
+    }
+
+    // `previous`: everyone's position a turn before `s`
+    int new_node(const SimState &s, const int *previous)
+    {
+        nodes.emplace_back();
+        Node &node = nodes.back();
+        for (int i = 0; i < MAX_SIM_PLAYERS; ++i)
+        {
+            int n = i < s.num_players ? model.safe_moves(s, i, node.moves[i]) : 0;
+            double probs[MAX_SIM_MOVES];
+            bool confident = false;
+            if (n > 0 && i != searcher && opponents && opponents->predict(s, i, previous[i], node.moves[i], n, probs, &confident) && confident)
+                n = keep_likely_moves(node.moves[i], probs, n, config.prior_cutoff);
+            node.num_moves[i] = uint8_t(n);
+            for (int a = 0; a < MAX_SIM_MOVES; ++a)
+            {
+                node.visits[i][a] = 0;
+                node.value_sum[i][a] = 0.0f;
+            }
+        }
+        node.total_visits = 0;
+        node.joint = 0;
+        node.first_child = -1;
+        node.next_sibling = -1;
+        return int(nodes.size()) - 1;
+    }
+
+    int select_move(const Node &node, int player)
+    {
+        int n = node.num_moves[player];
+        int untried = 0;
+        for (int a = 0; a < n; ++a)
+            untried += (node.visits[player][a] == 0);
+        if (untried > 0)
+        {
+            int pick = random_below(untried);
+            for (int a = 0; a < n; ++a)
+            {
+                if (node.visits[player][a] == 0 && pick-- == 0)
+                    return a;
+            }
+        }
+
+        double log_total = std::log(double(node.total_visits));
+        int best = 0;
+        double best_ucb = -1.0;
+        for (int a = 0; a < n; ++a)
+        {
+            double visits = node.visits[player][a];
+            double ucb = node.value_sum[player][a] / visits + config.exploration * std::sqrt(log_total / visits);
+            if (ucb > best_ucb)
+            {
+                best_ucb = ucb;
+                best = a;
+            }
+        }
+        return best;
+    }
+
+    int find_child(int parent, uint32_t joint) const
+    {
+        for (int child = nodes[parent].first_child; child >= 0; child = nodes[child].next_sibling)
+        {
+            if (nodes[child].joint == joint)
+                return child;
+        }
+        return -1;
+    }
+
+    void run_iteration(const SimState &root, int horizon_turn)
+    {
+        SimState s = root;
+        SimMove moves[MAX_SIM_PLAYERS];
+        int previous[MAX_SIM_PLAYERS];
+        std::copy(root_previous, root_previous + MAX_SIM_PLAYERS, previous);
+        int depth = 0;
+        int node = 0;
+        bool in_tree = true;
+
+        while (in_tree && s.turn < horizon_turn && !is_terminal(s) && depth < MAX_TREE_DEPTH)
+        {
+            PathStep &step = path[depth++];
+            step.node = node;
+            uint32_t joint = 0;
+            for (int i = 0; i < s.num_players; ++i)
+            {
+                const Node &current = nodes[node];
+                int choice = current.num_moves[i] > 0 ? select_move(current, i) : 0;
+                step.choice[i] = uint8_t(choice);
+                moves[i] = current.num_moves[i] > 0 ? current.moves[i][choice] : SimMove{-1, -1};
+                joint = joint * MAX_SIM_MOVES + uint32_t(choice);
+            }
+            remember_positions(s, previous);
+            model.step(s, moves);
+
+            int child = find_child(node, joint);
+            if (child < 0)
+            {
+                in_tree = false;
+                if (int(nodes.size()) < config.max_nodes)
+                {
+                    child = new_node(s, previous);
+                    nodes[child].joint = joint;
+                    nodes[child].next_sibling = nodes[node].first_child;
+                    nodes[node].first_child = child;
+                }
+            }
+            node = child;
+        }
+
+        while (s.turn < horizon_turn && !is_terminal(s))
+        {
+            for (int i = 0; i < s.num_players; ++i)
+                moves[i] = playout_move(s, i, previous[i]);
+            remember_positions(s, previous);
+            model.step(s, moves);
+        }
+
+        double reward[MAX_SIM_PLAYERS];
+        score(s, reward);
+        for (int d = 0; d < depth; ++d)
+        {
+            Node &n = nodes[path[d].node];
+            ++n.total_visits;
+            for (int i = 0; i < s.num_players; ++i)
+            {
+                if (n.num_moves[i] == 0)
+                    continue;
+                int a = path[d].choice[i];
+                ++n.visits[i][a];
+                n.value_sum[i][a] += float(reward[i]);
+            }
+        }
+    }
+
+    static void remember_positions(const SimState &s, int *previous)
+    {
+        for (int i = 0; i < s.num_players; ++i)
+            previous[i] = s.players[i].pos;
+    }
+
+    static bool is_terminal(const SimState &s)
+    {
+        return s.count_alive() == 0 || s.is_game_over();
+    }
+
+    // Survival is worth half the reward, the share of the coloured area the rest
+    static void score(const SimState &s, double *reward)
+    {
+        int area[MAX_SIM_PLAYERS];
+        int total = 0;
+        for (int i = 0; i < s.num_players; ++i)
+        {
+            area[i] = s.area_of(i);
+            total += area[i];
+        }
+        for (int i = 0; i < s.num_players; ++i)
+        {
+            double share = total > 0 ? double(area[i]) / total : 0.0;
+            reward[i] = (s.players[i].alive ? 0.5 : 0.0) + 0.5 * share;
+        }
+    }
+
+    // An opponent the model has a fit for plays a move drawn from its
+    // prediction; everyone else the greedy move, or a random one
+    SimMove playout_move(const SimState &s, int player, int previous)
+    {
+        SimMove options[MAX_SIM_MOVES];
+        int n = model.safe_moves(s, player, options);
+        if (n == 0)
+            return SimMove{-1, -1};
+        double probs[MAX_SIM_MOVES];
+        if (player != searcher && opponents && opponents->predict(s, player, previous, options, n, probs))
+        {
+            double pick = random_unit();
+            for (int a = 0; a < n - 1; ++a)
+            {
+                pick -= probs[a];
+                if (pick < 0.0)
+                    return options[a];
+            }
+            return options[n - 1];
+        }
+        if (random_unit() < config.random_moves)
+            return options[random_below(n)];
+
+        const SealSchedule &seals = model.seal_schedule(s);
+        int best = 0, ties = 0;
+        double best_score = -1e18;
+        for (int a = 0; a < n; ++a)
+        {
+            double value = score_move(s, player, options[a], weights, seals);
+            if (value > best_score)
+            {
+                best_score = value;
+                best = a;
+                ties = 1;
+            }
+            else if (value == best_score && random_below(++ties) == 0)
+            {
+                best = a;
+            }
+        }
+        return options[best];
+    }
+};
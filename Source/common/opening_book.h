@@ -0,0 +1,140 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+#include "flat_grid.h"
+
+// --- Opening Book ---
+//
+// Where to stand on turn 0. Source/opening_book plays a bot from each map's
+// starting cells against real opponents in the arena and writes the best few,
+// best first, to that bot's opening_book_data.h, keyed by opening_map_hash
+// of the turn-0 board. The book is compiled in, so the bot finds its map with
+// one hash and a scan of a few entries, and reads no file on turn 0. On a map
+// its book does not know, it takes the cell rank_start_cells puts first.
+
+const int OPENING_BOOK_CELLS = 4;
+const unsigned char OPENING_BOOK_NONE = 255; // Pads a row with fewer cells
+
+struct OpeningBookEntry
+{
+    uint64_t map_hash;
+    const char *map_name;                       // The map file the entry was built on
+    unsigned char cells[OPENING_BOOK_CELLS][2]; // (row, col), best first
+};
+
+// FNV-1a over M, N, K and which cells are blocked. A turn-0 board shows
+// nothing else (no paint, no items), so this is the map as main.py loaded it.
+inline uint64_t opening_map_hash(const FlatGrid &grid, int K)
+{
+    uint64_t hash = 14695981039346656037ull;
+    auto mix = [&hash](uint64_t value)
+    {
+        hash ^= value;
+        hash *= 1099511628211ull;
+    };
+    mix(uint64_t(grid.M));
+    mix(uint64_t(grid.N));
+    mix(uint64_t(K));
+    for (int r = 0; r < grid.M; ++r)
+    {
+        for (int c = 0; c < grid.N; ++c)
+            mix(is_blocked_cell(grid.at(r, c)) ? 1 : 0);
+    }
+    return hash;
+}
+
+// rank_start_cells's terms, in points. Sealed cells keep their colour and can
+// no longer be taken, so a start one or two rings in from the edge banks its
+// first paint within 2K-3K turns and still has time to walk inward, while the
+// middle is contested all game. In the builder's sweeps over every cell of
+// the maps in Simulator/Map, both bots did best from there overall.
+const double OPENING_REACH = 100.0;   // Times the share of the board's free cells the start can walk to
+const double OPENING_BEST_RING = 1.5; // Between rings 1 and 2
+const double OPENING_RING = 4.0;      // Per ring away from OPENING_BEST_RING
+const int OPENING_ROOM_CAP = 12;      // Free cells in the 5x5 square around the start that still count
+const double OPENING_ROOM = 0.3;      // Per such cell; low in corridors and chokepoints
+const double OPENING_CENTER = 0.2;    // Per step (Manhattan) away from the centre: corners over mid-edges
+
+// Every empty cell of a turn-0 board, best start first (ties in row-major order)
+inline std::vector<int> rank_start_cells(const FlatGrid &grid)
+{
+    const int neighbours[4] = {-grid.stride, grid.stride, -1, 1};
+    std::vector<int> component(grid.padded_size(), -1);
+    std::vector<int> component_size;
+    std::vector<int> cells, queue;
+    int free_cells = 0;
+    for (int r = 0; r < grid.M; ++r)
+    {
+        for (int c = 0; c < grid.N; ++c)
+        {
+            int start = grid.idx(r, c);
+            if (is_blocked_cell(grid[start]))
+                continue;
+            ++free_cells;
+            if (grid[start] == EMPTY_CELL)
+                cells.push_back(start);
+            if (component[start] >= 0)
+                continue;
+            // Flood fill the free cells reachable from here
+            int id = int(component_size.size());
+            component[start] = id;
+            queue.assign(1, start);
+            for (size_t head = 0; head < queue.size(); ++head)
+            {
+                for (int d : neighbours)
+                {
+                    int next = queue[head] + d;
+                    if (!is_blocked_cell(grid[next]) && component[next] < 0)
+                    {
+                        component[next] = id;
+                        queue.push_back(next);
+                    }
+                }
+            }
+            component_size.push_back(int(queue.size()));
+        }
+    }
+
+    std::vector<double> score(grid.padded_size(), 0.0);
+    for (int i : cells)
+    {
+        int r = grid.row_of(i), c = grid.col_of(i);
+        int ring = std::min(std::min(r, grid.M - 1 - r), std::min(c, grid.N - 1 - c));
+        int room = 0;
+        for (int dr = -2; dr <= 2; ++dr)
+        {
+            for (int dc = -2; dc <= 2; ++dc)
+                room += !is_blocked_cell(grid[i + grid.delta(dr, dc)]);
+        }
+        double center = std::abs(2 * r - (grid.M - 1)) / 2.0 + std::abs(2 * c - (grid.N - 1)) / 2.0;
+        score[i] = OPENING_REACH * component_size[component[i]] / free_cells - OPENING_RING * std::fabs(ring - OPENING_BEST_RING) +
+                   OPENING_ROOM * std::min(room, OPENING_ROOM_CAP) + OPENING_CENTER * center;
+    }
+    std::stable_sort(cells.begin(), cells.end(), [&score](int a, int b) { return score[a] > score[b]; });
+    return cells;
+}
+
+// Flat index of the cell to start on: the best cell `book` lists for the map
+// that is empty, or else rank_start_cells's best; -1 if no cell is empty
+template <int N>
+int opening_start(const OpeningBookEntry (&book)[N], const FlatGrid &grid, int K)
+{
+    uint64_t map_hash = opening_map_hash(grid, K);
+    for (const OpeningBookEntry &entry : book)
+    {
+        if (entry.map_hash != map_hash)
+            continue;
+        for (const auto &cell : entry.cells)
+        {
+            if (cell[0] != OPENING_BOOK_NONE && grid.is_within_bounds(cell[0], cell[1]) && grid.at(cell[0], cell[1]) == EMPTY_CELL)
+                return grid.idx(cell[0], cell[1]);
+        }
+    }
+    std::vector<int> ranked = rank_start_cells(grid);
+    return ranked.empty() ? -1 : ranked[0];
+}
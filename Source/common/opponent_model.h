@@ -0,0 +1,330 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+
+#include "forward_model.h"
+
+// --- Opponent Model ---
+//
+// What each opponent is likely to play next, learned from the current game
+// alone. The bot shows the model every turn (observe), which keeps the last
+// few positions of each opponent in a ring buffer and scores a few cheap
+// policies by whether they predicted the move just seen:
+//   - PERSIST: the same direction as last turn, or staying again. OnlyUp and
+//     OnlyDown fit it from their second move on.
+//   - NEAREST_EMPTY: a step onto an adjacent empty cell.
+//   - ITEM_CHASE: closer to the nearest item (Manhattan).
+// Scores decay by OPPONENT_DECAY per turn, so a bot that changes its ways is
+// followed within a few turns. An opponent's move distribution is the best
+// policy's moves, mixed with uniform by how often that policy was right.
+// predict() reads nothing but a SimState and where the player stood a turn
+// before, so the searches use it at any depth. Between processes the model
+// goes to STATE.DAT as one line of text (format / parse).
+
+enum OpponentPolicy
+{
+    POLICY_PERSIST = 0,
+    POLICY_NEAREST_EMPTY,
+    POLICY_ITEM_CHASE,
+    NUM_OPPONENT_POLICIES
+};
+
+// Direction of a move as a bit, so a policy's prediction is a mask of them
+enum MoveDirection
+{
+    DIRECTION_STAY = 1,
+    DIRECTION_UP = 2,
+    DIRECTION_DOWN = 4,
+    DIRECTION_LEFT = 8,
+    DIRECTION_RIGHT = 16
+};
+
+const int OPPONENT_HISTORY = 8;         // Positions kept per opponent
+const double OPPONENT_DECAY = 0.85;     // Weight of a policy's older scores per turn
+const double OPPONENT_MIN_TRIALS = 2.5; // Decayed predictions a policy needs before it is used (three moves)
+const double OPPONENT_CONFIDENT = 0.9;  // Hit rate above which the searches drop the other moves
+
+// Direction from one cell to another of a straight move of up to 2 cells;
+// 0 for anything else (a jump the rules do not allow, or no position)
+inline int move_direction(const FlatGrid &g, int from, int to)
+{
+    if (from < 0 || to < 0)
+        return 0;
+    int dr = g.row_of(to) - g.row_of(from), dc = g.col_of(to) - g.col_of(from);
+    if (dr != 0 && dc != 0)
+        return 0;
+    if (std::abs(dr) > 2 || std::abs(dc) > 2)
+        return 0;
+    if (dr < 0)
+        return DIRECTION_UP;
+    if (dr > 0)
+        return DIRECTION_DOWN;
+    if (dc < 0)
+        return DIRECTION_LEFT;
+    if (dc > 0)
+        return DIRECTION_RIGHT;
+    return DIRECTION_STAY;
+}
+
+class OpponentModel
+{
+public:
+    OpponentModel() { reset(); }
+
+    void reset()
+    {
+        last_turn = -1;
+        for (Track &t : tracks)
+            t = Track();
+    }
+
+    // Scores last turn's predictions against the positions in `s` and
+    // predicts again from them. Called once per turn, for player `me`; a turn
+    // that does not follow the last one observed starts a new game.
+    void observe(const SimState &s, int me)
+    {
+        if (last_turn < 0 || s.turn != last_turn + 1)
+            reset();
+        for (int i = 0; i < MAX_SIM_PLAYERS; ++i)
+        {
+            Track &t = tracks[i];
+            if (i == me || i >= s.num_players || !s.players[i].alive || s.players[i].pos < 0)
+            {
+                t = Track();
+                continue;
+            }
+            int pos = s.players[i].pos;
+            int seen = t.count > 0 ? move_direction(s.grid, t.newest(), pos) : 0;
+            for (int k = 0; k < NUM_OPPONENT_POLICIES; ++k)
+            {
+                t.hits[k] *= OPPONENT_DECAY;
+                t.likelihood[k] *= OPPONENT_DECAY;
+                t.trials[k] *= OPPONENT_DECAY;
+                if (seen == 0 || t.masks[k] == 0)
+                    continue;
+                bool hit = (t.masks[k] & seen) != 0;
+                t.trials[k] += 1.0;
+                t.hits[k] += hit;
+                t.likelihood[k] += hit ? 1.0 / popcount(t.masks[k]) : 0.0;
+            }
+            int previous = t.count > 0 ? t.newest() : -1;
+            t.push(pos);
+            for (int k = 0; k < NUM_OPPONENT_POLICIES; ++k)
+                t.masks[k] = uint8_t(policy_mask(s, i, previous, k));
+        }
+        last_turn = s.turn;
+    }
+
+    // Where `player` stood the turn before the last one observed, -1 if unknown
+    int previous_position(int player) const
+    {
+        const Track &t = tracks[player];
+        return t.count >= 2 ? t.at(t.count - 2) : -1;
+    }
+
+    // Fills probs[a] for moves[0..n) of `player` in `s`, who stood on
+    // `previous` a turn earlier (-1 if unknown). Returns false, leaving probs
+    // alone, while no policy has fit the player yet or the best one says
+    // nothing here. `confident` tells whether that policy is nearly always right.
+    bool predict(const SimState &s, int player, int previous, const SimMove *moves, int n, double *probs, bool *confident = nullptr) const
+    {
+        int policy = tracks[player].best_policy();
+        if (policy < 0 || n <= 0)
+            return false;
+        int mask = policy_mask(s, player, previous, policy);
+        int pos = s.players[player].pos;
+        int matching = 0;
+        for (int a = 0; a < n; ++a)
+            matching += (move_direction(s.grid, pos, s.grid.idx(moves[a].x, moves[a].y)) & mask) != 0;
+        if (matching == 0)
+            return false;
+
+        double rate = tracks[player].hit_rate(policy);
+        for (int a = 0; a < n; ++a)
+        {
+            bool predicted = (move_direction(s.grid, pos, s.grid.idx(moves[a].x, moves[a].y)) & mask) != 0;
+            probs[a] = (1.0 - rate) / n + (predicted ? rate / matching : 0.0);
+        }
+        if (confident)
+            *confident = rate >= OPPONENT_CONFIDENT;
+        return true;
+    }
+
+    // The model as one line: the last turn observed, then per colour the
+    // positions oldest first and each policy's masks and scores. Empty if
+    // nothing was observed.
+    std::string format() const
+    {
+        if (last_turn < 0)
+            return "";
+        std::string text = std::to_string(last_turn);
+        char number[64];
+        for (const Track &t : tracks)
+        {
+            text += " " + std::to_string(t.count);
+            for (int j = 0; j < t.count; ++j)
+                text += " " + std::to_string(t.at(j));
+            for (int k = 0; k < NUM_OPPONENT_POLICIES; ++k)
+            {
+                std::snprintf(number, sizeof(number), " %d %.4g %.4g %.4g", t.masks[k], t.hits[k], t.likelihood[k], t.trials[k]);
+                text += number;
+            }
+        }
+        return text;
+    }
+
+    // Reads format()'s line back; anything else resets the model
+    bool parse(const std::string &text)
+    {
+        reset();
+        std::istringstream in(text);
+        OpponentModel parsed;
+        if (!(in >> parsed.last_turn))
+            return false;
+        for (Track &t : parsed.tracks)
+        {
+            int count = 0;
+            if (!(in >> count) || count < 0 || count > OPPONENT_HISTORY)
+                return false;
+            for (int j = 0; j < count; ++j)
+            {
+                int pos = 0;
+                if (!(in >> pos) || pos < 0 || pos >= MAX_PADDED_CELLS)
+                    return false;
+                t.push(pos);
+            }
+            for (int k = 0; k < NUM_OPPONENT_POLICIES; ++k)
+            {
+                int mask = 0;
+                if (!(in >> mask >> t.hits[k] >> t.likelihood[k] >> t.trials[k]))
+                    return false;
+                t.masks[k] = uint8_t(mask & 31);
+            }
+        }
+        *this = parsed;
+        return true;
+    }
+
+private:
+    struct Track
+    {
+        int positions[OPPONENT_HISTORY] = {}; // Ring buffer, newest at head - 1
+        int head = 0;
+        int count = 0;
+        uint8_t masks[NUM_OPPONENT_POLICIES] = {}; // Each policy's prediction for the next move
+        double hits[NUM_OPPONENT_POLICIES] = {};       // Decayed predictions that contained the move
+        double likelihood[NUM_OPPONENT_POLICIES] = {}; // The same, each divided by the directions it allowed
+        double trials[NUM_OPPONENT_POLICIES] = {};     // Decayed predictions made
+
+        void push(int pos)
+        {
+            positions[head] = pos;
+            head = (head + 1) % OPPONENT_HISTORY;
+            count = std::min(count + 1, OPPONENT_HISTORY);
+        }
+
+        // j-th position kept, oldest first
+        int at(int j) const { return positions[(head - count + j + OPPONENT_HISTORY) % OPPONENT_HISTORY]; }
+        int newest() const { return at(count - 1); }
+
+        // As if there had been one more prediction, half right, so a few
+        // lucky ones are not taken for certainty: about six hits in a row
+        // reach OPPONENT_CONFIDENT
+        double hit_rate(int k) const { return (hits[k] + 0.5) / (trials[k] + 1.0); }
+
+        // The policy that put most probability on the moves seen, among
+        // those that made enough predictions; -1 if none did
+        int best_policy() const
+        {
+            int best = -1;
+            for (int k = 0; k < NUM_OPPONENT_POLICIES; ++k)
+            {
+                if (trials[k] >= OPPONENT_MIN_TRIALS && (best < 0 || likelihood[k] / trials[k] > likelihood[best] / trials[best]))
+                    best = k;
+            }
+            return best;
+        }
+    };
+
+    int last_turn;
+    Track tracks[MAX_SIM_PLAYERS];
+
+    static int popcount(int mask)
+    {
+        int bits = 0;
+        for (; mask; mask &= mask - 1)
+            ++bits;
+        return bits;
+    }
+
+    // Directions `policy` expects `player` to move in next; 0 when it has
+    // nothing to say (no last move, no empty neighbour, no item)
+    static int policy_mask(const SimState &s, int player, int previous, int policy)
+    {
+        const FlatGrid &g = s.grid;
+        int pos = s.players[player].pos;
+        if (pos < 0)
+            return 0;
+        const int steps[4] = {-g.stride, g.stride, -1, 1};
+        const int bits[4] = {DIRECTION_UP, DIRECTION_DOWN, DIRECTION_LEFT, DIRECTION_RIGHT};
+        int mask = 0;
+        switch (policy)
+        {
+        case POLICY_PERSIST:
+            return move_direction(g, previous, pos);
+        case POLICY_NEAREST_EMPTY:
+            for (int d = 0; d < 4; ++d)
+            {
+                if (g[pos + steps[d]] == EMPTY_CELL)
+                    mask |= bits[d];
+            }
+            return mask;
+        case POLICY_ITEM_CHASE:
+        {
+            int r = g.row_of(pos), c = g.col_of(pos);
+            int best = -1, best_distance = 0;
+            for (int k = 0; k < s.num_items; ++k)
+            {
+                int distance = std::abs(g.row_of(s.items[k].pos) - r) + std::abs(g.col_of(s.items[k].pos) - c);
+                if (distance > 0 && (best < 0 || distance < best_distance))
+                {
+                    best = s.items[k].pos;
+                    best_distance = distance;
+                }
+            }
+            if (best < 0)
+                return 0;
+            int dr = g.row_of(best) - r, dc = g.col_of(best) - c;
+            mask |= dr < 0 ? DIRECTION_UP : dr > 0 ? DIRECTION_DOWN : 0;
+            mask |= dc < 0 ? DIRECTION_LEFT : dc > 0 ? DIRECTION_RIGHT : 0;
+            return mask;
+        }
+        }
+        return 0;
+    }
+};
+
+// Drops the moves a confident prediction gives less than `cutoff`, keeping
+// probs in step; all of them stay if none would. Returns the new count.
+inline int keep_likely_moves(SimMove *moves, double *probs, int n, double cutoff)
+{
+    int kept = 0;
+    for (int a = 0; a < n; ++a)
+        kept += probs[a] >= cutoff;
+    if (kept == 0 || kept == n)
+        return n;
+    kept = 0;
+    for (int a = 0; a < n; ++a)
+    {
+        if (probs[a] >= cutoff)
+        {
+            moves[kept] = moves[a];
+            probs[kept++] = probs[a];
+        }
+    }
+    return kept;
+}
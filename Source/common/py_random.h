@@ -0,0 +1,126 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// --- Python-Compatible Random ---
+//
+// The subset of CPython's `random` module that main.py draws from (shuffle,
+// randint, choice, sample), on the same MT19937 with the same seeding, so a
+// game replayed with random.seed(n) in the simulator makes identical draws.
+// Everything reduces to _randbelow, which takes the top k bits of one 32-bit
+// output (k = n.bit_length()) and retries while the result is >= n.
+
+class PyRandom
+{
+public:
+    explicit PyRandom(uint64_t seed_value = 0) { seed(seed_value); }
+
+    // random.seed(n) for a non-negative int: init_by_array over its 32-bit words
+    void seed(uint64_t n)
+    {
+        uint32_t key[2] = {uint32_t(n), uint32_t(n >> 32)};
+        init_by_array(key, (n >> 32) ? 2 : 1);
+    }
+
+    uint32_t next_u32()
+    {
+        if (index >= N)
+            twist();
+        uint32_t y = state[index++];
+        y ^= (y >> 11);
+        y ^= (y << 7) & 0x9d2c5680U;
+        y ^= (y << 15) & 0xefc60000U;
+        y ^= (y >> 18);
+        return y;
+    }
+
+    // random.getrandbits(k) for 0 <= k <= 32
+    uint32_t getrandbits(int k) { return k <= 0 ? 0 : next_u32() >> (32 - k); }
+
+    // random._randbelow(n): uniform in [0, n)
+    int randbelow(int n)
+    {
+        if (n <= 0)
+            return 0;
+        int k = 0;
+        while ((uint32_t(n) >> k) != 0)
+            ++k;
+        uint32_t r = getrandbits(k);
+        while (r >= uint32_t(n))
+            r = getrandbits(k);
+        return int(r);
+    }
+
+    // random.randint(a, b)
+    int randint(int a, int b) { return a + randbelow(b - a + 1); }
+
+    // random.shuffle(x)
+    template <typename T>
+    void shuffle(std::vector<T> &x)
+    {
+        for (int i = int(x.size()) - 1; i > 0; --i)
+        {
+            int j = randbelow(i + 1);
+            std::swap(x[i], x[j]);
+        }
+    }
+
+    // Lets a PyRandom stand in for ForwardModel::spawn_power_ups's `rng(n)`
+    int operator()(int n) { return randbelow(n); }
+
+private:
+    static const int N = 624;
+    static const int M = 397;
+    uint32_t state[N];
+    int index;
+
+    void init_genrand(uint32_t s)
+    {
+        state[0] = s;
+        for (int i = 1; i < N; ++i)
+            state[i] = 1812433253U * (state[i - 1] ^ (state[i - 1] >> 30)) + uint32_t(i);
+        index = N;
+    }
+
+    void init_by_array(const uint32_t *key, int key_length)
+    {
+        init_genrand(19650218U);
+        int i = 1, j = 0;
+        for (int k = (N > key_length ? N : key_length); k; --k)
+        {
+            state[i] = (state[i] ^ ((state[i - 1] ^ (state[i - 1] >> 30)) * 1664525U)) + key[j] + uint32_t(j);
+            ++i;
+            ++j;
+            if (i >= N)
+            {
+                state[0] = state[N - 1];
+                i = 1;
+            }
+            if (j >= key_length)
+                j = 0;
+        }
+        for (int k = N - 1; k; --k)
+        {
+            state[i] = (state[i] ^ ((state[i - 1] ^ (state[i - 1] >> 30)) * 1566083941U)) - uint32_t(i);
+            ++i;
+            if (i >= N)
+            {
+                state[0] = state[N - 1];
+                i = 1;
+            }
+        }
+        state[0] = 0x80000000U;
+        index = N;
+    }
+
+    void twist()
+    {
+        for (int i = 0; i < N; ++i)
+        {
+            uint32_t y = (state[i] & 0x80000000U) | (state[(i + 1) % N] & 0x7fffffffU);
+            state[i] = state[(i + M) % N] ^ (y >> 1) ^ ((y & 1U) ? 0x9908b0dfU : 0U);
+        }
+        index = 0;
+    }
+};
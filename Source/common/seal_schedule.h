@@ -0,0 +1,118 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+#include "flat_grid.h"
+
+// --- Seal Schedule ---
+//
+// The turn at whose end Board.shrink seals each cell. Ring r (cells r steps
+// from the nearest edge) goes when the shrink radius reaches r. The radius
+// moves on at every turn that is a multiple of K, and on every turn once
+// nobody is alive. On the regular schedule ring r is sealed at the end of turn
+// (r + 1) * K. build() lays that out once per board shape and K. set_turn()
+// re-anchors it when the radius is somewhere else, and leaves the table alone
+// otherwise, so a probe is a single load. Cells sealed before the current
+// turn, and the sentinel frame, read as a turn already past.
+
+class SealSchedule
+{
+public:
+    SealSchedule() : M(0), N(0), K(0), shift(0), turn(0), radius(0), every_turn(false) {}
+
+    bool matches(const FlatGrid &grid, int period) const
+    {
+        return grid.M == M && grid.N == N && int(ring.size()) == grid.padded_size() && period == K;
+    }
+
+    void build(const FlatGrid &grid, int period)
+    {
+        M = grid.M;
+        N = grid.N;
+        K = period;
+        ring.assign(grid.padded_size(), -1);
+        for (int r = 0; r < M; ++r)
+        {
+            for (int c = 0; c < N; ++c)
+                ring[grid.idx(r, c)] = std::min(std::min(r, M - 1 - r), std::min(c, N - 1 - c));
+        }
+        shift = 0;
+        every_turn = false;
+        turn = radius = 0;
+        fill();
+    }
+
+    // `current_turn` is being played and `next_ring` is the ring the next
+    // shrink seals (SimState::radius). `anyone_alive` false means main.py
+    // shrinks at the end of every turn from now on.
+    void set_turn(int current_turn, int next_ring, bool anyone_alive = true)
+    {
+        if (!anyone_alive && K > 0)
+        {
+            // Still never on turn 0
+            int first_shrink = std::max(1, current_turn);
+            if (every_turn && first_shrink - next_ring == turn - radius)
+                return;
+            every_turn = true;
+            turn = first_shrink;
+            radius = next_ring;
+            fill();
+            return;
+        }
+        if (K <= 0)
+        {
+            if (every_turn)
+            {
+                every_turn = false;
+                fill();
+            }
+            return;
+        }
+        // First turn from now that is a multiple of K (main.py never shrinks on turn 0)
+        int first_shrink = std::max(1, (current_turn + K - 1) / K) * K;
+        int new_shift = first_shrink - (next_ring + 1) * K;
+        if (!every_turn && new_shift == shift)
+            return;
+        every_turn = false;
+        shift = new_shift;
+        fill();
+    }
+
+    // Turn at whose end `idx` gets sealed
+    int seal_turn(int idx) const { return seals[idx]; }
+
+    // Whether Board.shrink runs at the end of turn `t` (t >= the turn last
+    // set), sealing a ring or, once they are all gone, nothing
+    bool shrinks_on(int t) const
+    {
+        if (every_turn)
+            return t >= turn;
+        return K > 0 && t > 0 && t % K == 0;
+    }
+
+private:
+    int M, N, K;
+    int shift;        // Regular schedule moved by this many turns
+    int turn, radius; // Anchor of the every-turn schedule
+    bool every_turn;
+    std::vector<int> ring; // -1 off the board
+    std::vector<int> seals;
+
+    void fill()
+    {
+        const int never = 1 << 30;
+        const int past = -(1 << 30);
+        seals.resize(ring.size());
+        for (size_t i = 0; i < ring.size(); ++i)
+        {
+            int r = ring[i];
+            if (r < 0)
+                seals[i] = past;
+            else if (every_turn)
+                seals[i] = turn + (r - radius);
+            else
+                seals[i] = K > 0 ? (r + 1) * K + shift : never;
+        }
+    }
+};
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdlib>
+
+#include "forward_model.h"
+#include "seal_schedule.h"
+#include "time_manager.h"
+
+// --- Shared Search Pieces ---
+
+const int MAX_SIM_MOVES = 9; // Stay, 4 steps and 4 boosted two-steps (ForwardModel::legal_moves)
+
+// Cheap one-move heuristic used for playouts and move ordering. Same priorities
+// as evaluate_move (items first, then painting, then shrink and centre terms),
+// on a scale where painting an empty cell is worth 1.
+struct MoveWeights
+{
+    double item_pickup = 20.0;
+    double paint_empty = 1.0;
+    double paint_enemy = 1.5;
+    double paint_own = 0.1;
+    double stay = -0.1;
+    double sealed_this_turn = -1000.0;
+    double shrink_per_turn = 0.08;
+    double center_per_cell = 0.01;
+};
+
+// `seals` is ForwardModel::seal_schedule(s)
+inline double score_move(const SimState &s, int player, const SimMove &move, const MoveWeights &weights, const SealSchedule &seals)
+{
+    const FlatGrid &g = s.grid;
+    const SimPlayer &p = s.players[player];
+    int idx = g.idx(move.x, move.y);
+    char cell = g[idx];
+    double value = 0.0;
+
+    if (idx == p.pos)
+        value += weights.stay;
+    if (cell == EMPTY_CELL)
+        value += weights.paint_empty;
+    else if (cell == p.color)
+        value += weights.paint_own;
+    else if (cell >= 'A' && cell <= 'D')
+        value += weights.paint_enemy;
+    if (p.powerup == POWERUP_NONE && s.find_item(idx) >= 0)
+        value += weights.item_pickup;
+
+    if (s.K > 0)
+    {
+        int turns_until_shrink = seals.seal_turn(idx) - s.turn;
+        if (turns_until_shrink <= 0)
+            value += weights.sealed_this_turn;
+        else if (turns_until_shrink <= s.K)
+            value -= (s.K - turns_until_shrink + 1) * weights.shrink_per_turn;
+    }
+    value -= (std::abs(move.x - g.M / 2) + std::abs(move.y - g.N / 2)) * weights.center_per_cell;
+    return value;
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "bitboard.h"
+#include "flat_grid.h"
+
+// --- Territory ---
+//
+// Voronoi split of the board between the live players: one multi-source BFS,
+// run a turn at a time, gives every cell to the player who can stand on it
+// first. A player with a speed boost expands two steps a turn while it lasts.
+// Cells two players reach on the same turn are contested and belong to nobody;
+// neither player expands through them. The cells a player owns that are not
+// already its colour are what it can still paint before anyone else gets there.
+
+const int MAX_TERRITORY_PLAYERS = NUM_COLORS;
+const int8_t TERRITORY_NONE = -1;
+const int8_t TERRITORY_CONTESTED = -2;
+
+struct TerritorySource
+{
+    int pos;         // Flat index, -1 for a dead or absent player
+    int boost_turns; // Turns left on a speed boost, 0 without one
+    char color;      // 'A'..'D'
+};
+
+class Territory
+{
+public:
+    int reached[MAX_TERRITORY_PLAYERS]; // Cells owned, own start included
+    int gain[MAX_TERRITORY_PLAYERS];    // Owned cells that are empty or an enemy's colour
+
+    Territory()
+    {
+        for (int k = 0; k < MAX_TERRITORY_PLAYERS; ++k)
+            reached[k] = gain[k] = 0;
+    }
+
+    // `is_wall(idx)` must hold for the sentinel frame; the BFS has no bounds check
+    template <typename IsWall>
+    void compute(const FlatGrid &grid, const TerritorySource *sources, int num_sources, IsWall is_wall)
+    {
+        int size = grid.padded_size();
+        owner.assign(size, TERRITORY_NONE);
+        claim_turn.assign(size, 0);
+        for (int k = 0; k < MAX_TERRITORY_PLAYERS; ++k)
+        {
+            reached[k] = gain[k] = 0;
+            frontier[k].clear();
+        }
+
+        bool growing = false;
+        for (int k = 0; k < num_sources; ++k)
+        {
+            int pos = sources[k].pos;
+            if (pos < 0)
+                continue;
+            owner[pos] = owner[pos] == TERRITORY_NONE ? int8_t(k) : TERRITORY_CONTESTED;
+            frontier[k].push_back(pos);
+            growing = true;
+        }
+
+        const int offsets[4] = {-grid.stride, grid.stride, -1, 1};
+        for (int turn = 1; growing; ++turn)
+        {
+            growing = false;
+            // Everyone's first step of the turn, then the boosted players' second
+            for (int step = 0; step < 2; ++step)
+            {
+                for (int k = 0; k < num_sources; ++k)
+                {
+                    if (frontier[k].empty() || (step == 1 && sources[k].boost_turns < turn))
+                        continue;
+                    next[k].clear();
+                    for (int curr : frontier[k])
+                    {
+                        if (owner[curr] != k)
+                            continue; // Contested after it was queued
+                        for (int offset : offsets)
+                        {
+                            int cell = curr + offset;
+                            if (owner[cell] == TERRITORY_NONE)
+                            {
+                                if (is_wall(cell))
+                                    continue;
+                                owner[cell] = int8_t(k);
+                                claim_turn[cell] = uint16_t(turn);
+                                next[k].push_back(cell);
+                            }
+                            else if (owner[cell] >= 0 && owner[cell] != k && claim_turn[cell] == turn)
+                            {
+                                owner[cell] = TERRITORY_CONTESTED;
+                            }
+                        }
+                    }
+                    frontier[k].swap(next[k]);
+                    growing = growing || !frontier[k].empty();
+                }
+            }
+        }
+
+        for (int r = 0; r < grid.M; ++r)
+        {
+            int idx = grid.idx(r, 0);
+            for (int c = 0; c < grid.N; ++c, ++idx)
+            {
+                int k = owner[idx];
+                if (k < 0)
+                    continue;
+                ++reached[k];
+                if (grid[idx] != sources[k].color)
+                    ++gain[k];
+            }
+        }
+    }
+
+    // Player index owning `idx`, or TERRITORY_NONE / TERRITORY_CONTESTED
+    int owner_of(int idx) const { return owner[idx]; }
+
+private:
+    std::vector<int8_t> owner;
+    std::vector<uint16_t> claim_turn;
+    std::vector<int> frontier[MAX_TERRITORY_PLAYERS];
+    std::vector<int> next[MAX_TERRITORY_PLAYERS];
+};
@@ -0,0 +1,167 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// --- Thread Pool ---
+//
+// A fixed set of threads for splitting one search across cores. run() hands
+// out a batch of n tasks round-robin to per-thread queues; every thread works
+// off the back of its own queue and, once that is empty, steals from the front
+// of the others, so a few slow tasks (root moves differ a lot in cost) do not
+// leave the other threads idle. The calling thread takes part as worker 0,
+// which also makes a pool of size 1 plain sequential code with no threads.
+
+class ThreadPool
+{
+public:
+    typedef std::function<void(int task, int worker)> Task;
+
+    // `num_threads` includes the caller; 0 means one per hardware thread
+    explicit ThreadPool(int num_threads)
+    {
+        if (num_threads <= 0)
+            num_threads = std::max(1u, std::thread::hardware_concurrency());
+        queues.resize(num_threads);
+        for (auto &queue : queues)
+            queue.reset(new TaskQueue());
+        for (int w = 1; w < num_threads; ++w)
+            threads.emplace_back(&ThreadPool::worker_loop, this, w);
+    }
+
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(batch_mutex);
+            shutting_down = true;
+        }
+        batch_ready.notify_all();
+        for (auto &thread : threads)
+            thread.join();
+    }
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    int size() const { return int(queues.size()); }
+
+    // Runs task(i, worker) for every i in [0, n) and returns once all are
+    // done. `worker` is in [0, size()) and unique among concurrently running
+    // tasks, so it can index per-thread state. Not reentrant.
+    void run(int n, const Task &task)
+    {
+        if (n <= 0)
+            return;
+        if (size() == 1)
+        {
+            for (int i = 0; i < n; ++i)
+                task(i, 0);
+            return;
+        }
+
+        // The task is published before its indices, so a thread still draining
+        // the previous batch never pops an index without seeing the new task
+        {
+            std::lock_guard<std::mutex> lock(batch_mutex);
+            current = &task;
+            pending.store(n);
+        }
+        for (int i = 0; i < n; ++i)
+        {
+            TaskQueue &queue = *queues[i % size()];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.tasks.push_back(i);
+        }
+        {
+            std::lock_guard<std::mutex> lock(batch_mutex);
+            ++batch;
+        }
+        batch_ready.notify_all();
+
+        work_until_empty(0);
+        std::unique_lock<std::mutex> lock(batch_mutex);
+        batch_done.wait(lock, [&] { return pending.load() == 0; });
+        current = nullptr;
+    }
+
+private:
+    struct TaskQueue
+    {
+        std::mutex mutex;
+        std::deque<int> tasks;
+    };
+
+    std::vector<std::unique_ptr<TaskQueue>> queues;
+    std::vector<std::thread> threads;
+
+    std::mutex batch_mutex;
+    std::condition_variable batch_ready;
+    std::condition_variable batch_done;
+    const Task *current = nullptr;
+    std::atomic<int> pending{0};
+    long long batch = 0;
+    bool shutting_down = false;
+
+    bool pop_own(int worker, int &task)
+    {
+        TaskQueue &queue = *queues[worker];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty())
+            return false;
+        task = queue.tasks.back();
+        queue.tasks.pop_back();
+        return true;
+    }
+
+    bool steal(int worker, int &task)
+    {
+        for (int k = 1; k < size(); ++k)
+        {
+            TaskQueue &queue = *queues[(worker + k) % size()];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (queue.tasks.empty())
+                continue;
+            task = queue.tasks.front();
+            queue.tasks.pop_front();
+            return true;
+        }
+        return false;
+    }
+
+    void work_until_empty(int worker)
+    {
+        int task;
+        while (pop_own(worker, task) || steal(worker, task))
+        {
+            (*current)(task, worker);
+            if (pending.fetch_sub(1) == 1)
+            {
+                std::lock_guard<std::mutex> lock(batch_mutex);
+                batch_done.notify_all();
+            }
+        }
+    }
+
+    void worker_loop(int worker)
+    {
+        long long seen = 0;
+        for (;;)
+        {
+            {
+                std::unique_lock<std::mutex> lock(batch_mutex);
+                batch_ready.wait(lock, [&] { return shutting_down || batch != seen; });
+                if (shutting_down)
+                    return;
+                seen = batch;
+            }
+            work_until_empty(worker);
+        }
+    }
+};
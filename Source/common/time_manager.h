@@ -0,0 +1,109 @@
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+#include <ostream>
+#include <string>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#endif
+
+// --- Time Management ---
+//
+// main.py runs each bot under subprocess.check_call(timeout = 2) and then reads
+// whatever MOVE.OUT holds, even from a bot it had to kill; without a fresh
+// MOVE.OUT that is last turn's file, or (-1, -1). A turn is therefore split into
+// phases against one monotonic clock started at process entry, the search gets
+// whatever the earlier phases left of the budget, and the bot publishes a move
+// as soon as it has one (see write_file_atomically).
+
+typedef std::chrono::steady_clock SearchClock;
+
+enum TurnPhase
+{
+    PHASE_PARSE,      // MAP.INP and STATE.DAT
+    PHASE_PRECOMPUTE, // Planes, fallback move, search setup
+    PHASE_SEARCH,
+    PHASE_OUTPUT,     // MOVE.OUT and STATE.DAT
+    NUM_TURN_PHASES
+};
+
+class TimeManager
+{
+public:
+    // `budget_ms` is the whole turn measured from `start`; `output_reserve_ms`
+    // of it is kept back from the search for writing the answer.
+    TimeManager(SearchClock::time_point start, int budget_ms, int output_reserve_ms = 30)
+        : start(start), phase_start(start), phase(PHASE_PARSE),
+          deadline(start + std::chrono::milliseconds(budget_ms)),
+          output_reserve(std::chrono::milliseconds(output_reserve_ms))
+    {
+        for (double &ms : phase_ms)
+            ms = 0.0;
+    }
+
+    // Closes the current phase and starts `next`
+    void begin_phase(TurnPhase next)
+    {
+        SearchClock::time_point now = SearchClock::now();
+        phase_ms[phase] += std::chrono::duration<double, std::milli>(now - phase_start).count();
+        phase = next;
+        phase_start = now;
+    }
+
+    // When the search has to return: the budget minus the output reserve, so it
+    // shrinks by however long parsing and precomputation took
+    SearchClock::time_point search_deadline() const { return deadline - output_reserve; }
+
+    SearchClock::time_point turn_deadline() const { return deadline; }
+
+    double elapsed_ms() const { return std::chrono::duration<double, std::milli>(SearchClock::now() - start).count(); }
+
+    bool past_search_deadline() const { return SearchClock::now() >= search_deadline(); }
+
+    // One line of per-phase times, the current phase up to now
+    void report(std::ostream &out) const
+    {
+        static const char *names[NUM_TURN_PHASES] = {"parse", "precompute", "search", "output"};
+        double running = std::chrono::duration<double, std::milli>(SearchClock::now() - phase_start).count();
+        out << "time:";
+        for (int p = 0; p < NUM_TURN_PHASES; ++p)
+            out << " " << names[p] << " " << phase_ms[p] + (p == phase ? running : 0.0) << " ms";
+        out << ", total " << elapsed_ms() << " ms" << std::endl;
+    }
+
+private:
+    SearchClock::time_point start;
+    SearchClock::time_point phase_start;
+    TurnPhase phase;
+    SearchClock::time_point deadline;
+    SearchClock::duration output_reserve;
+    double phase_ms[NUM_TURN_PHASES];
+};
+
+// Writes `contents` to `<filename>.tmp` and renames it over `filename`, so a
+// reader (or a kill) never sees a half-written file: it gets the old contents
+// or the new ones.
+inline bool write_file_atomically(const std::string &filename, const std::string &contents)
+{
+    std::string temp = filename + ".tmp";
+    std::FILE *file = std::fopen(temp.c_str(), "wb");
+    if (!file)
+        return false;
+    bool written = std::fwrite(contents.data(), 1, contents.size(), file) == contents.size();
+    written = (std::fclose(file) == 0) && written;
+    if (!written)
+    {
+        std::remove(temp.c_str());
+        return false;
+    }
+#ifdef _WIN32
+    // std::rename will not replace an existing file on Windows
+    return MoveFileExA(temp.c_str(), filename.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+    return std::rename(temp.c_str(), filename.c_str()) == 0;
+#endif
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+#include "bitboard.h"
+#include "flat_grid.h"
+
+// --- Window Sums ---
+//
+// Summed-area table of one BitPlane over the board: sums[(r + 1) * (N + 1) +
+// (c + 1)] is the number of set cells in rows 0..r and columns 0..c. Built once
+// per turn in one pass, it answers any rectangle count with four lookups, so
+// window scores (paint bomb reach, local density) cost the same for a 5x5 or a
+// 21x21 window and nothing per opponent.
+
+class WindowSums
+{
+public:
+    WindowSums() : M(0), N(0) {}
+
+    void build(const FlatGrid &grid, const BitPlane &plane)
+    {
+        M = grid.M;
+        N = grid.N;
+        sums.assign(size_t(M + 1) * (N + 1), 0);
+        for (int r = 0; r < M; ++r)
+        {
+            int idx = grid.idx(r, 0);
+            int row_total = 0;
+            for (int c = 0; c < N; ++c, ++idx)
+            {
+                row_total += plane.test(idx);
+                at(r + 1, c + 1) = at(r, c + 1) + row_total;
+            }
+        }
+    }
+
+    // Set cells in rows r0..r1 and columns c0..c1 (inclusive), clipped to the board
+    int count(int r0, int c0, int r1, int c1) const
+    {
+        r0 = std::max(r0, 0);
+        c0 = std::max(c0, 0);
+        r1 = std::min(r1, M - 1);
+        c1 = std::min(c1, N - 1);
+        if (r0 > r1 || c0 > c1)
+            return 0;
+        return at(r1 + 1, c1 + 1) - at(r0, c1 + 1) - at(r1 + 1, c0) + at(r0, c0);
+    }
+
+    // Set cells in the (2 * radius + 1)^2 square centred on (r, c)
+    int count_around(int r, int c, int radius) const
+    {
+        return count(r - radius, c - radius, r + radius, c + radius);
+    }
+
+private:
+    int M, N;
+    std::vector<int> sums;
+
+    int &at(int r, int c) { return sums[size_t(r) * (N + 1) + c]; }
+    int at(int r, int c) const { return sums[size_t(r) * (N + 1) + c]; }
+};
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <cstdint>
+
+#include "bitboard.h"
+#include "flat_grid.h"
+
+// --- Zobrist Hashing ---
+//
+// 64-bit position keys for transposition tables and caches. The keys come from
+// a fixed seed, so a position hashes the same in every run and every process.
+// An empty cell, a dead player and "no power-up" contribute nothing, which lets
+// owners of a hash keep it current by XOR-ing out the old key of whatever they
+// change and XOR-ing in the new one.
+
+const int ZOBRIST_CELL_KINDS = 9;   // '#', 'A'..'D', 'a'..'d'
+const int ZOBRIST_ITEM_KINDS = 3;   // 'G', 'E', 'F'
+const int ZOBRIST_POWERUP_KINDS = 3; // Indexed by PowerUpKind; 0 is never hashed
+const int ZOBRIST_MAX_TIMER = 8;    // Power-up counters 0..7
+const int ZOBRIST_MAX_TURNS = 512;  // Turns are folded into this many keys
+const int ZOBRIST_MAX_RADIUS = MAX_BOARD_DIM / 2 + 1;
+
+inline uint64_t splitmix64(uint64_t &state)
+{
+    uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// -1 for '.' and anything else that is not hashed
+inline int zobrist_cell_kind(char cell)
+{
+    if (cell == OBSTACLE_CELL)
+        return 0;
+    if (cell >= 'A' && cell <= 'D')
+        return 1 + (cell - 'A');
+    if (cell >= 'a' && cell <= 'd')
+        return 5 + (cell - 'a');
+    return -1;
+}
+
+inline int zobrist_item_kind(char type)
+{
+    return type == SPEED_BOOST_ITEM ? 0 : type == PAINT_BOMB_ITEM ? 1 : type == OIL_SLICK_ITEM ? 2 : -1;
+}
+
+class ZobristKeys
+{
+public:
+    uint64_t cell[MAX_PADDED_CELLS][ZOBRIST_CELL_KINDS];
+    uint64_t player[NUM_COLORS][MAX_PADDED_CELLS];
+    uint64_t last_mid[NUM_COLORS][MAX_PADDED_CELLS];
+    uint64_t powerup[NUM_COLORS][ZOBRIST_POWERUP_KINDS][ZOBRIST_MAX_TIMER];
+    uint64_t item[MAX_PADDED_CELLS][ZOBRIST_ITEM_KINDS];
+    uint64_t turn[ZOBRIST_MAX_TURNS];
+    uint64_t radius[ZOBRIST_MAX_RADIUS];
+
+    // One shared, lazily built table (~700 KB)
+    static const ZobristKeys &instance()
+    {
+        static const ZobristKeys keys;
+        return keys;
+    }
+
+    uint64_t cell_key(int idx, char cell) const
+    {
+        int kind = zobrist_cell_kind(cell);
+        return kind >= 0 ? this->cell[idx][kind] : 0;
+    }
+
+    uint64_t item_key(int idx, char type) const
+    {
+        int kind = zobrist_item_kind(type);
+        return kind >= 0 ? item[idx][kind] : 0;
+    }
+
+    // Player `color` holding power-up `kind` with `turns` left
+    uint64_t powerup_key(int color, int kind, int turns) const
+    {
+        if (kind <= 0 || kind >= ZOBRIST_POWERUP_KINDS || turns < 0 || turns >= ZOBRIST_MAX_TIMER)
+            return 0;
+        return powerup[color][kind][turns];
+    }
+
+    uint64_t turn_key(int t) const { return turn[((t % ZOBRIST_MAX_TURNS) + ZOBRIST_MAX_TURNS) % ZOBRIST_MAX_TURNS]; }
+    uint64_t radius_key(int r) const { return r >= 0 && r < ZOBRIST_MAX_RADIUS ? radius[r] : 0; }
+
+private:
+    ZobristKeys()
+    {
+        uint64_t state = 0x5A0B1257C0FFEE11ULL;
+        for (auto &keys : cell)
+            for (uint64_t &key : keys)
+                key = splitmix64(state);
+        for (int i = 0; i < NUM_COLORS; ++i)
+        {
+            for (uint64_t &key : player[i])
+                key = splitmix64(state);
+            for (uint64_t &key : last_mid[i])
+                key = splitmix64(state);
+            for (auto &keys : powerup[i])
+                for (uint64_t &key : keys)
+                    key = splitmix64(state);
+        }
+        for (auto &keys : item)
+            for (uint64_t &key : keys)
+                key = splitmix64(state);
+        for (uint64_t &key : turn)
+            key = splitmix64(state);
+        for (uint64_t &key : radius)
+            key = splitmix64(state);
+    }
+};
+
+inline const ZobristKeys &zobrist_keys()
+{
+    return ZobristKeys::instance();
+}
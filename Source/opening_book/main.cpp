@@ -0,0 +1,368 @@
+#include <dirent.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../common/match.h"
+#include "../common/opening_book.h"
+#include "../common/thread_pool.h"
+
+// --- Opening Book Builder ---
+//
+// Ranks the starting cells of every map by playing them, and writes the best
+// ones to a bot's opening book (see opening_book.h):
+//   opening_book [options] --write=Source/bot/opening_book_data.h PLAYER OPPONENT...
+// The candidates on each map are the empty cells at least --spacing apart,
+// taken in rank_start_cells order (--candidates keeps only the first ones).
+// PLAYER is placed on each of them in turn, whatever it answers on turn 0,
+// and plays every OPPONENT over --seeds seeds in both seat orders; the
+// opponents start where they like. Every candidate gets the same seeds, so
+// they are compared on the same power-up draws. Cells are ranked by mean
+// score (1 for the largest area, 0.5 for a shared one), then by mean area,
+// and the best OPENING_BOOK_CELLS go into the book. Entries for maps not
+// played are kept.
+
+struct BookOptions
+{
+    std::vector<std::string> maps; // Every map in map_dir when empty
+    std::string map_dir = "Simulator/Map";
+    uint64_t seed = 1;
+    int jobs = 0;
+    int timeout_ms = 2000;
+    std::string temp_dir;
+    int candidates = 0; // Cells played per map; 0 for all
+    int spacing = 3;    // Minimum Chebyshev distance between two candidates
+    int seeds = 20;     // Per candidate and opponent, each played in both seat orders
+    std::string write;  // opening_book_data.h to rewrite
+};
+
+// One candidate cell and how PLAYER did from it
+struct CandidateResult
+{
+    int cell;
+    int heuristic_rank; // Position in rank_start_cells
+    double score = 0.0;
+    double area = 0.0;
+};
+
+std::string map_path(const BookOptions &options, const std::string &name)
+{
+    if (name.find('/') != std::string::npos)
+        return name;
+    std::string file = name.find('.') == std::string::npos ? name + ".txt" : name;
+    return options.map_dir + "/" + file;
+}
+
+std::vector<std::string> list_maps(const std::string &map_dir)
+{
+    std::vector<std::string> names;
+    if (DIR *dir = opendir(map_dir.c_str()))
+    {
+        while (dirent *entry = readdir(dir))
+        {
+            std::string name = entry->d_name;
+            if (name.size() > 4 && name.compare(name.size() - 4, 4, ".txt") == 0)
+                names.push_back(name);
+        }
+        closedir(dir);
+    }
+    std::sort(names.begin(), names.end());
+    return names;
+}
+
+// The first `count` cells of `ranked` (all for 0) that keep `spacing` from
+// each other
+std::vector<int> spread_candidates(const FlatGrid &grid, const std::vector<int> &ranked, int count, int spacing)
+{
+    std::vector<int> picked;
+    for (int cell : ranked)
+    {
+        if (count > 0 && int(picked.size()) == count)
+            break;
+        bool apart = true;
+        for (int other : picked)
+        {
+            int distance = std::max(std::abs(grid.row_of(cell) - grid.row_of(other)), std::abs(grid.col_of(cell) - grid.col_of(other)));
+            apart = apart && distance >= spacing;
+        }
+        if (apart)
+            picked.push_back(cell);
+    }
+    return picked;
+}
+
+// One line of opening_book_data.h
+struct BookLine
+{
+    uint64_t map_hash;
+    std::string map_name;
+    std::string text;
+};
+
+BookLine format_entry(uint64_t map_hash, const std::string &map_name, const std::vector<std::pair<int, int>> &cells)
+{
+    char text[64];
+    std::snprintf(text, sizeof(text), "    {0x%016llxull, \"", (unsigned long long)map_hash);
+    BookLine line = {map_hash, map_name, text + map_name + "\", {"};
+    for (int k = 0; k < OPENING_BOOK_CELLS; ++k)
+    {
+        std::pair<int, int> cell = k < int(cells.size()) ? cells[k] : std::make_pair(int(OPENING_BOOK_NONE), int(OPENING_BOOK_NONE));
+        line.text += (k ? ", {" : "{") + std::to_string(cell.first) + ", " + std::to_string(cell.second) + "}";
+    }
+    line.text += "}},";
+    return line;
+}
+
+// The entries of an existing opening_book_data.h, as written by format_book
+std::vector<BookLine> read_book(const std::string &filename)
+{
+    std::vector<BookLine> lines;
+    std::string text;
+    if (!read_whole_file(filename, text))
+        return lines;
+    std::istringstream in(text);
+    std::string row;
+    while (std::getline(in, row))
+    {
+        unsigned long long map_hash;
+        char map_name[256];
+        if (std::sscanf(row.c_str(), " {0x%llxull, \"%255[^\"]\"", &map_hash, map_name) == 2)
+            lines.push_back({map_hash, map_name, row});
+    }
+    return lines;
+}
+
+// opening_book_data.h holding `lines`
+std::string format_book(const std::vector<BookLine> &lines)
+{
+    std::string text = "#pragma once\n\n"
+                       "// Written by Source/opening_book; rebuild the bots after changing it.\n"
+                       "// Per map: opening_map_hash of its turn-0 board, the map file, and its best\n"
+                       "// starting cells (row, col), best first.\n"
+                       "const OpeningBookEntry OPENING_BOOK[] = {\n";
+    for (const BookLine &line : lines)
+        text += line.text + "\n";
+    text += "};\n";
+    return text;
+}
+
+void print_usage(const char *program)
+{
+    std::cerr << "usage: " << program << " [--map=NAME]... [--map-dir=DIR] [--seed=N] [--jobs=N] [--temp-dir=DIR]\n"
+              << "       [--candidates=N] [--spacing=N] [--seeds=N] [--write=FILE] PLAYER OPPONENT...\n"
+              << "players are lib:path[ options] (built with -DBOT_LIBRARY) or exe:path, e.g. \"lib:./libbot.so\"" << std::endl;
+}
+
+bool parse_options(int argc, char *argv[], BookOptions &options, std::vector<PlayerSpec> &players)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg.compare(0, 6, "--map=") == 0)
+        {
+            std::istringstream names(arg.substr(6));
+            std::string name;
+            while (std::getline(names, name, ','))
+                options.maps.push_back(name);
+        }
+        else if (arg.compare(0, 10, "--map-dir=") == 0)
+            options.map_dir = arg.substr(10);
+        else if (arg.compare(0, 7, "--seed=") == 0)
+            options.seed = std::strtoull(arg.c_str() + 7, nullptr, 10);
+        else if (arg.compare(0, 7, "--jobs=") == 0)
+            options.jobs = std::max(0, std::atoi(arg.c_str() + 7));
+        else if (arg.compare(0, 11, "--temp-dir=") == 0)
+            options.temp_dir = arg.substr(11);
+        else if (arg.compare(0, 13, "--candidates=") == 0)
+            options.candidates = std::max(0, std::atoi(arg.c_str() + 13));
+        else if (arg.compare(0, 10, "--spacing=") == 0)
+            options.spacing = std::max(1, std::atoi(arg.c_str() + 10));
+        else if (arg.compare(0, 8, "--seeds=") == 0)
+            options.seeds = std::max(1, std::atoi(arg.c_str() + 8));
+        else if (arg.compare(0, 8, "--write=") == 0)
+            options.write = arg.substr(8);
+        else if (arg.compare(0, 2, "--") == 0)
+        {
+            std::cerr << "Error: unknown option " << arg << std::endl;
+            return false;
+        }
+        else
+        {
+            PlayerSpec spec;
+            std::string error;
+            if (!parse_player_spec(arg, spec, &error))
+            {
+                std::cerr << "Error: " << error << std::endl;
+                return false;
+            }
+            players.push_back(spec);
+        }
+    }
+    return players.size() >= 2;
+}
+
+int main(int argc, char *argv[])
+{
+    std::ios_base::sync_with_stdio(false);
+    BookOptions options;
+    std::vector<PlayerSpec> players;
+    if (!parse_options(argc, argv, options, players))
+    {
+        print_usage(argv[0]);
+        return 1;
+    }
+    if (options.maps.empty())
+        options.maps = list_maps(options.map_dir);
+    if (options.maps.empty())
+    {
+        std::cerr << "Error: no maps in " << options.map_dir << std::endl;
+        return 1;
+    }
+    std::vector<MatchMap> maps(options.maps.size());
+    for (size_t m = 0; m < maps.size(); ++m)
+    {
+        std::string error;
+        if (!load_match_map(map_path(options, options.maps[m]), maps[m], &error))
+        {
+            std::cerr << "Error: " << error << std::endl;
+            return 1;
+        }
+    }
+
+    if (options.temp_dir.empty())
+        options.temp_dir = std::getenv("TMPDIR") ? std::getenv("TMPDIR") : "/tmp";
+    std::string root_template = options.temp_dir + "/opening_book-XXXXXX";
+    if (!mkdtemp(&root_template[0]))
+    {
+        std::cerr << "Error: cannot create a folder in " << options.temp_dir << std::endl;
+        return 1;
+    }
+    const std::string root = root_template;
+
+    ThreadPool pool(options.jobs);
+    std::vector<std::unique_ptr<MatchWorker>> workers;
+    for (int w = 0; w < pool.size(); ++w)
+        workers.emplace_back(new MatchWorker(root + "/worker" + std::to_string(w), options.timeout_ms, false));
+    const int opponents = int(players.size()) - 1;
+    const int games_per_cell = 2 * options.seeds * opponents;
+    std::cout << "Placing " << players[0].label << " on "
+              << (options.candidates ? std::to_string(options.candidates) : std::string("all")) << " cells "
+              << options.spacing << " apart on each map against " << opponents << " opponent(s), " << games_per_cell << " games per cell on " << pool.size() << " thread(s)" << std::endl;
+
+    std::vector<BookLine> entries;
+    long long total_games = 0;
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    for (size_t m = 0; m < maps.size(); ++m)
+    {
+        const MatchMap &map = maps[m];
+        SimState board;
+        start_match(map, 1, board);
+        std::vector<int> ranked = rank_start_cells(board.grid);
+        std::vector<int> picked = spread_candidates(board.grid, ranked, options.candidates, options.spacing);
+        std::vector<CandidateResult> results;
+        for (int cell : picked)
+        {
+            CandidateResult candidate;
+            candidate.cell = cell;
+            candidate.heuristic_rank = int(std::find(ranked.begin(), ranked.end(), cell) - ranked.begin());
+            results.push_back(candidate);
+        }
+        if (results.empty())
+        {
+            std::cout << map.name << ": no empty cell, left out" << std::endl;
+            continue;
+        }
+
+        // Task = candidate x opponent x seed x seat order
+        int tasks = int(results.size()) * games_per_cell;
+        std::vector<MatchResult> games(tasks);
+        total_games += tasks;
+        std::mutex error_mutex;
+        bool failed = false;
+        pool.run(tasks,
+                 [&](int task, int w)
+                 {
+                     int j = task / games_per_cell;
+                     int rest = task % games_per_cell;
+                     int opponent = 1 + rest / (2 * options.seeds);
+                     int s = rest % (2 * options.seeds) / 2;
+                     bool swapped = rest % 2 == 1;
+                     std::vector<int> seating = swapped ? std::vector<int>{opponent, 0} : std::vector<int>{0, opponent};
+                     SimMove starts[2] = {{-1, -1}, {-1, -1}};
+                     int cell = results[j].cell;
+                     starts[swapped ? 1 : 0] = {board.grid.row_of(cell), board.grid.col_of(cell)};
+                     std::string error;
+                     if (!workers[w]->play(map, players, seating, options.seed + s, "game" + std::to_string(task), games[task], &error,
+                                           starts))
+                     {
+                         std::lock_guard<std::mutex> lock(error_mutex);
+                         if (!failed)
+                             std::cerr << "Error: " << error << std::endl;
+                         failed = true;
+                     }
+                 });
+        if (failed)
+        {
+            workers.clear();
+            remove_directory_tree(root);
+            return 1;
+        }
+        for (int task = 0; task < tasks; ++task)
+        {
+            CandidateResult &candidate = results[task / games_per_cell];
+            int seat = task % 2 == 1 ? 1 : 0;
+            candidate.score += match_score(games[task], seat) / games_per_cell;
+            candidate.area += double(games[task].area[seat]) / games_per_cell;
+        }
+        std::stable_sort(results.begin(), results.end(),
+                         [](const CandidateResult &a, const CandidateResult &b)
+                         { return a.score != b.score ? a.score > b.score : a.area > b.area; });
+
+        std::cout << "\n" << map.name << " (" << map.M << "x" << map.N << ", K " << map.K << ")\n";
+        for (size_t j = 0; j < results.size(); ++j)
+        {
+            char line[120];
+            std::snprintf(line, sizeof(line), "%3zu. (%2d, %2d)  heuristic #%-3d score %.3f  area %.1f", j + 1,
+                          board.grid.row_of(results[j].cell), board.grid.col_of(results[j].cell), results[j].heuristic_rank + 1,
+                          results[j].score, results[j].area);
+            std::cout << line << "\n";
+        }
+        std::cout << std::flush;
+
+        std::vector<std::pair<int, int>> best;
+        for (const CandidateResult &candidate : results)
+            best.push_back({board.grid.row_of(candidate.cell), board.grid.col_of(candidate.cell)});
+        entries.push_back(format_entry(opening_map_hash(board.grid, map.K), map.name, best));
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    std::cout << "\n" << total_games << " games in " << elapsed << " s" << std::endl;
+    workers.clear(); // Unloads the plugins before their files go
+    remove_directory_tree(root);
+
+    if (!options.write.empty() && !entries.empty())
+    {
+        // Maps not played this time keep their entries
+        for (const BookLine &old : read_book(options.write))
+        {
+            bool replaced = std::any_of(entries.begin(), entries.end(), [&old](const BookLine &entry) { return entry.map_hash == old.map_hash; });
+            if (!replaced)
+                entries.push_back(old);
+        }
+        std::stable_sort(entries.begin(), entries.end(), [](const BookLine &a, const BookLine &b) { return a.map_name < b.map_name; });
+        if (!write_file(options.write, format_book(entries)))
+        {
+            std::cerr << "Error: cannot write " << options.write << std::endl;
+            return 1;
+        }
+        std::cout << "Wrote " << entries.size() << " map(s) to " << options.write << "; rebuild the bots to compile them in" << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,445 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../common/match.h"
+
+// --- Parity ---
+//
+// Checks the native rules against Simulator/main.py on data the simulator
+// produced, so a change to the forward model that breaks parity shows up:
+//   parity [--replays=FILE] [--boards=FILE] [--random-boards=N] [--seed=N]
+// The replay file (Source/parity/replays.txt by default, written by
+// Simulator/pack_replays.py) holds logged games. Each one starts from its
+// first logged board with start_match, then every turn plays the positions
+// of the next logged turn as the moves and adds the logged power-ups when
+// step() says a spawn is due. The grid, players and power-ups must then equal
+// that turn's log.
+// The board file (Source/parity/boards.txt, written by
+// Simulator/pack_boards.py) holds boards before and after board.py's own
+// Board.updateCoveredArea; EnclosureMap must capture the same cells. On top
+// of that, --random-boards boards up to 60x60 are drawn here and every cell
+// EnclosureMap captures is checked against a port of checkBorderReachable.
+// Exits with 1 if any check fails.
+
+struct ReplayPlayer
+{
+    int x, y;
+    bool alive;
+    int boost_turns, oil_turns;
+    uint8_t powerup; // PowerUpKind
+};
+
+struct ReplayItem
+{
+    int x, y;
+    char type;
+    int timeout;
+};
+
+struct ReplayTurn
+{
+    int turn;
+    std::vector<ReplayPlayer> players;
+    std::vector<std::string> rows;
+    std::vector<ReplayItem> items;
+};
+
+struct ReplayGame
+{
+    std::string name;
+    int M, N, K, num_players;
+    std::vector<ReplayTurn> turns;
+};
+
+bool read_replay_turn(std::istream &in, const ReplayGame &game, ReplayTurn &turn, std::string *error)
+{
+    std::string tag;
+    if (!(in >> tag >> turn.turn) || tag != "TURN")
+        return map_parse_fail(error, game.name + ": expected TURN");
+    turn.players.resize(size_t(game.num_players));
+    for (ReplayPlayer &p : turn.players)
+    {
+        int alive = 0;
+        std::string powerup;
+        if (!(in >> p.x >> p.y >> alive >> p.boost_turns >> p.oil_turns >> powerup))
+            return map_parse_fail(error, game.name + ": turn " + std::to_string(turn.turn) + " has too few players");
+        p.alive = alive != 0;
+        if (powerup == "none")
+            p.powerup = POWERUP_NONE;
+        else if (powerup == "tangtoc")
+            p.powerup = POWERUP_SPEED_BOOST;
+        else if (powerup == "dautron")
+            p.powerup = POWERUP_OIL_SLICK;
+        else
+            return map_parse_fail(error, game.name + ": bad power-up '" + powerup + "'");
+    }
+    turn.rows.resize(size_t(game.M));
+    for (std::string &row : turn.rows)
+    {
+        if (!(in >> row) || int(row.size()) != game.N)
+            return map_parse_fail(error, game.name + ": turn " + std::to_string(turn.turn) + " has a bad row");
+    }
+    int num_items = 0;
+    if (!(in >> num_items) || num_items < 0 || num_items > MAX_SIM_ITEMS)
+        return map_parse_fail(error, game.name + ": turn " + std::to_string(turn.turn) + " has a bad power-up count");
+    turn.items.resize(size_t(num_items));
+    for (ReplayItem &item : turn.items)
+    {
+        if (!(in >> item.x >> item.y >> item.type >> item.timeout))
+            return map_parse_fail(error, game.name + ": turn " + std::to_string(turn.turn) + " has too few power-ups");
+    }
+    return true;
+}
+
+bool load_replays(const std::string &filename, std::vector<ReplayGame> &games, std::string *error)
+{
+    std::ifstream in(filename);
+    if (!in)
+        return map_parse_fail(error, "could not open " + filename);
+    std::string tag;
+    while (in >> tag)
+    {
+        ReplayGame game;
+        int num_turns = 0;
+        if (tag != "GAME" || !(in >> game.name >> game.M >> game.N >> game.K >> game.num_players >> num_turns))
+            return map_parse_fail(error, filename + ": expected GAME");
+        if (game.M <= 0 || game.N <= 0 || game.M > MAX_BOARD_DIM || game.N > MAX_BOARD_DIM || game.num_players < 1 ||
+            game.num_players > MAX_SIM_PLAYERS || num_turns < 1)
+            return map_parse_fail(error, filename + ": " + game.name + " has a bad header");
+        game.turns.resize(size_t(num_turns));
+        for (ReplayTurn &turn : game.turns)
+        {
+            if (!read_replay_turn(in, game, turn, error))
+                return false;
+        }
+        games.push_back(game);
+    }
+    return true;
+}
+
+// What in `s` differs from the logged turn, empty if nothing
+std::string replay_differences(const SimState &s, const ReplayTurn &logged)
+{
+    std::string diff;
+    if (s.turn != logged.turn)
+        diff += " turn " + std::to_string(s.turn) + ";";
+    for (int r = 0; r < s.grid.M; ++r)
+    {
+        for (int c = 0; c < s.grid.N; ++c)
+        {
+            if (s.grid.at(r, c) != logged.rows[r][c])
+                diff += " cell " + std::to_string(r) + "," + std::to_string(c) + " is '" + s.grid.at(r, c) + "' not '" + logged.rows[r][c] + "';";
+        }
+    }
+    for (int i = 0; i < s.num_players; ++i)
+    {
+        const SimPlayer &p = s.players[i];
+        const ReplayPlayer &q = logged.players[i];
+        // The log keeps a dead player's last position
+        if (p.alive != q.alive || (p.alive && p.pos != s.grid.idx(q.x, q.y)))
+            diff += std::string(" player ") + p.color + " position or life;";
+        if (p.boost_turns != q.boost_turns || p.oil_turns != q.oil_turns || p.powerup != q.powerup)
+            diff += std::string(" player ") + p.color + " power-up;";
+    }
+    bool items_match = s.num_items == int(logged.items.size());
+    for (int k = 0; items_match && k < s.num_items; ++k)
+    {
+        const SimItem &a = s.items[k];
+        const ReplayItem &b = logged.items[k];
+        items_match = a.pos == s.grid.idx(b.x, b.y) && a.type == b.type && a.timeout == b.timeout;
+    }
+    if (!items_match)
+        diff += " power-ups;";
+    return diff;
+}
+
+// Plays `game` through the forward model; false at the first turn that
+// differs from the log
+bool replay_game(ForwardModel &model, const ReplayGame &game)
+{
+    const ReplayTurn &first = game.turns[0];
+    MatchMap map;
+    map.name = game.name;
+    map.M = game.M;
+    map.N = game.N;
+    map.K = game.K;
+    map.rows = first.rows;
+    SimState s;
+    start_match(map, game.num_players, s);
+
+    for (size_t t = 1; t < game.turns.size(); ++t)
+    {
+        const ReplayTurn &next = game.turns[t];
+        SimMove moves[MAX_SIM_PLAYERS] = {};
+        int fallback_cells[MAX_SIM_PLAYERS] = {-1, -1, -1, -1};
+        for (int i = 0; i < game.num_players; ++i)
+        {
+            moves[i] = {next.players[i].x, next.players[i].y};
+            if (s.grid.is_within_bounds(moves[i].x, moves[i].y))
+                fallback_cells[i] = s.grid.idx(moves[i].x, moves[i].y);
+        }
+        if (s.turn == 0)
+            model.place_players(s, moves, fallback_cells);
+        StepResult step = model.step(s, moves);
+        if (step.spawn_due)
+        {
+            for (const ReplayItem &item : next.items)
+                s.add_item(s.grid.idx(item.x, item.y), item.type, item.timeout);
+        }
+
+        std::string diff = replay_differences(s, next);
+        if (!diff.empty())
+        {
+            // Hidden state (mid cells, the hash) cannot be rebuilt from the
+            // log, so the rest of the game would only repeat this difference
+            std::cout << "  " << game.name << " turn " << next.turn << ":" << diff.substr(0, 300) << '\n';
+            return false;
+        }
+    }
+    return true;
+}
+
+// --- Enclosures ---
+
+struct EnclosureBoard
+{
+    int M, N, num_colors;
+    std::vector<std::string> before, after;
+};
+
+bool load_boards(const std::string &filename, std::vector<EnclosureBoard> &boards, std::string *error)
+{
+    std::ifstream in(filename);
+    if (!in)
+        return map_parse_fail(error, "could not open " + filename);
+    std::string tag;
+    while (in >> tag)
+    {
+        EnclosureBoard board;
+        if (tag != "BOARD" || !(in >> board.M >> board.N >> board.num_colors))
+            return map_parse_fail(error, filename + ": expected BOARD");
+        if (board.M <= 0 || board.N <= 0 || board.M > MAX_BOARD_DIM || board.N > MAX_BOARD_DIM || board.num_colors < 1 ||
+            board.num_colors > NUM_COLORS)
+            return map_parse_fail(error, filename + ": board " + std::to_string(boards.size()) + " has a bad header");
+        board.before.resize(size_t(board.M));
+        board.after.resize(size_t(board.M));
+        for (std::vector<std::string> *rows : {&board.before, &board.after})
+        {
+            for (std::string &row : *rows)
+            {
+                if (!(in >> row) || int(row.size()) != board.N)
+                    return map_parse_fail(error, filename + ": board " + std::to_string(boards.size()) + " has a bad row");
+            }
+        }
+        boards.push_back(board);
+    }
+    return true;
+}
+
+// Board.updateCoveredArea through EnclosureMap, the way the forward model
+// runs it: colour by colour, each seeing the earlier colours' captures
+void cover_enclosed_cells(FlatGrid &g, int num_colors, EnclosureMap &enclosure)
+{
+    if (!enclosure.matches(g))
+        enclosure.build(g);
+    for (int k = 0; k < num_colors; ++k)
+    {
+        BitPlane walls, blocked, captured;
+        for (int r = 0; r < g.M; ++r)
+        {
+            for (int c = 0; c < g.N; ++c)
+            {
+                char cell = g.at(r, c);
+                if (color_index(cell) == k)
+                    walls.set(g.idx(r, c));
+                if (is_blocked_cell(cell))
+                    blocked.set(g.idx(r, c));
+            }
+        }
+        enclosure.captured_cells(walls, blocked, captured);
+        for (int r = 0; r < g.M; ++r)
+        {
+            for (int c = 0; c < g.N; ++c)
+            {
+                if (captured.test(g.idx(r, c)))
+                    g.at(r, c) = char('A' + k);
+            }
+        }
+    }
+}
+
+// Boards whose captures differ from updateCoveredArea's
+int check_boards(const std::vector<EnclosureBoard> &boards)
+{
+    EnclosureMap enclosure;
+    FlatGrid g;
+    int failed = 0;
+    for (size_t b = 0; b < boards.size(); ++b)
+    {
+        const EnclosureBoard &board = boards[b];
+        g.reset(board.M, board.N);
+        for (int r = 0; r < board.M; ++r)
+        {
+            for (int c = 0; c < board.N; ++c)
+                g.at(r, c) = board.before[r][c];
+        }
+        cover_enclosed_cells(g, board.num_colors, enclosure);
+        std::string diff;
+        for (int r = 0; r < board.M; ++r)
+        {
+            for (int c = 0; c < board.N; ++c)
+            {
+                if (g.at(r, c) != board.after[r][c])
+                    diff += " cell " + std::to_string(r) + "," + std::to_string(c) + " is '" + g.at(r, c) + "' not '" + board.after[r][c] + "';";
+            }
+        }
+        if (!diff.empty())
+        {
+            if (failed < 3)
+                std::cout << "  board " << b << " (" << board.M << "x" << board.N << "):" << diff.substr(0, 300) << '\n';
+            ++failed;
+        }
+    }
+    return failed;
+}
+
+// board.py checkBorderReachable: a BFS from (x, y) to the edge through any
+// cell that is not colour `color`, obstacles included
+bool border_reachable(const FlatGrid &g, int x, int y, char color)
+{
+    if (is_blocked_cell(g.at(x, y)) || g.at(x, y) == color)
+        return false;
+    if (x == 0 || y == 0 || x == g.M - 1 || y == g.N - 1)
+        return true;
+    std::vector<char> visited(size_t(g.M * g.N), 0);
+    std::deque<std::pair<int, int>> queue;
+    queue.push_back({x, y});
+    visited[x * g.N + y] = 1;
+    const int dx[4] = {-1, 0, 0, 1}, dy[4] = {0, -1, 1, 0};
+    while (!queue.empty())
+    {
+        std::pair<int, int> cell = queue.front();
+        queue.pop_front();
+        for (int d = 0; d < 4; ++d)
+        {
+            int nx = cell.first + dx[d], ny = cell.second + dy[d];
+            if (!g.is_within_bounds(nx, ny) || visited[nx * g.N + ny] || color_index(g.at(nx, ny)) == color - 'A')
+                continue;
+            if (nx == 0 || ny == 0 || nx == g.M - 1 || ny == g.N - 1)
+                return true;
+            visited[nx * g.N + ny] = 1;
+            queue.push_back({nx, ny});
+        }
+    }
+    return false;
+}
+
+// Random boards where EnclosureMap's capture for colour A differs from
+// checkBorderReachable somewhere
+int check_random_boards(int count, uint64_t seed)
+{
+    static const char CELLS[] = ".#AaBbCcDd";
+    std::mt19937_64 rng(seed);
+    EnclosureMap enclosure;
+    FlatGrid g;
+    int failed = 0;
+    for (int b = 0; b < count; ++b)
+    {
+        int M = 1 + int(rng() % MAX_BOARD_DIM), N = 1 + int(rng() % MAX_BOARD_DIM);
+        int density = int(rng() % 10);
+        g.reset(M, N);
+        BitPlane walls, blocked, captured;
+        for (int r = 0; r < M; ++r)
+        {
+            for (int c = 0; c < N; ++c)
+            {
+                char cell = int(rng() % 10) < density ? CELLS[rng() % 10] : (rng() % 3 ? 'A' : '.');
+                g.at(r, c) = cell;
+                if (color_index(cell) == 0)
+                    walls.set(g.idx(r, c));
+                if (is_blocked_cell(cell))
+                    blocked.set(g.idx(r, c));
+            }
+        }
+        enclosure.build(g);
+        enclosure.captured_cells(walls, blocked, captured);
+        bool same = true;
+        for (int r = 0; same && r < M; ++r)
+        {
+            for (int c = 0; same && c < N; ++c)
+            {
+                bool wanted = !is_blocked_cell(g.at(r, c)) && g.at(r, c) != 'A' && !border_reachable(g, r, c, 'A');
+                same = wanted == captured.test(g.idx(r, c));
+            }
+        }
+        if (!same)
+        {
+            if (failed < 3)
+                std::cout << "  random board " << b << " (" << M << "x" << N << ") differs\n";
+            ++failed;
+        }
+    }
+    return failed;
+}
+
+void print_usage(const char *program)
+{
+    std::cerr << "usage: " << program << " [--replays=FILE] [--boards=FILE] [--random-boards=N] [--seed=N]" << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+    std::ios_base::sync_with_stdio(false);
+    std::string replays_file = "Source/parity/replays.txt";
+    std::string boards_file = "Source/parity/boards.txt";
+    int random_boards = 2000;
+    uint64_t seed = 1;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg.compare(0, 10, "--replays=") == 0)
+            replays_file = arg.substr(10);
+        else if (arg.compare(0, 9, "--boards=") == 0)
+            boards_file = arg.substr(9);
+        else if (arg.compare(0, 16, "--random-boards=") == 0)
+            random_boards = std::max(0, std::atoi(arg.c_str() + 16));
+        else if (arg.compare(0, 7, "--seed=") == 0)
+            seed = std::strtoull(arg.c_str() + 7, nullptr, 10);
+        else
+        {
+            std::cerr << "Error: unknown option " << arg << std::endl;
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    std::vector<ReplayGame> games;
+    std::vector<EnclosureBoard> boards;
+    std::string error;
+    if (!load_replays(replays_file, games, &error) || !load_boards(boards_file, boards, &error))
+    {
+        std::cerr << "Error: " << error << std::endl;
+        return 1;
+    }
+    static ForwardModel model;
+    int turns = 0, failed = 0;
+    for (const ReplayGame &game : games)
+    {
+        turns += int(game.turns.size()) - 1;
+        failed += !replay_game(model, game);
+    }
+    std::cout << "replays: " << games.size() << " game(s), " << turns << " turn(s), " << failed << " failed" << std::endl;
+
+    int failed_boards = check_boards(boards);
+    std::cout << "boards: " << boards.size() << " board(s), " << failed_boards << " failed" << std::endl;
+    int failed_random = check_random_boards(random_boards, seed);
+    std::cout << "random boards: " << random_boards << " board(s), " << failed_random << " failed" << std::endl;
+    return failed + failed_boards + failed_random == 0 ? 0 : 1;
+}
@@ -0,0 +1,451 @@
+#include <dirent.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../common/match.h"
+#include "../common/thread_pool.h"
+
+// --- Tournament ---
+//
+// Head-to-head games between bots over maps x seeds x both seat orders,
+// played in parallel by the arena's match runner:
+//   tournament [options] PLAYER PLAYER [PLAYER...]
+// Round robin pairs every two players; --gauntlet pairs the first one with
+// each of the others, which is how a bot change is gated against the bots it
+// must beat. A game is won by the larger final area (findColoredArea) and
+// drawn on equal areas. Results are printed as games finish, then a table
+// of win rate, mean area and Elo with a 95% interval per player and per
+// pairing. With --sprt=ELO0,ELO1 a pairing stops as soon as a sequential
+// probability ratio test tells "no better than ELO0" from "at least ELO1"
+// apart for its first player.
+
+struct TournamentOptions
+{
+    std::vector<std::string> maps; // Every map in map_dir when empty
+    std::string map_dir = "Simulator/Map";
+    int seeds = 10; // Per map, pairing and seat order
+    uint64_t seed = 1;
+    bool gauntlet = false;
+    int jobs = 0;
+    int timeout_ms = 2000;
+    std::string temp_dir;
+    bool keep_dirs = false;
+    bool sprt = false;
+    double elo0 = 0.0, elo1 = 20.0;
+    double alpha = 0.05, beta = 0.05;
+};
+
+struct TournamentGame
+{
+    int pairing;
+    int map;
+    uint64_t seed;
+    bool swapped; // The pairing's second player sits as 'A'
+};
+
+// Games won, drawn and lost, from one side
+struct Record
+{
+    int wins = 0, draws = 0, losses = 0;
+    long long area = 0;
+
+    int games() const { return wins + draws + losses; }
+
+    void add(double score, int final_area)
+    {
+        wins += score == 1.0;
+        draws += score == 0.5;
+        losses += score == 0.0;
+        area += final_area;
+    }
+};
+
+struct Pairing
+{
+    int first, second;
+    Record record;            // The first player's
+    long long second_area = 0; // The second player's total
+    bool decided = false;
+    std::string verdict; // What SPRT accepted
+};
+
+// --- Statistics ---
+
+const double Z_95 = 1.959963984540054;
+
+double score_from_elo(double elo)
+{
+    return 1.0 / (1.0 + std::pow(10.0, -elo / 400.0));
+}
+
+// Infinite for a score of 0 or 1
+double elo_from_score(double score)
+{
+    if (score <= 0.0)
+        return -INFINITY;
+    if (score >= 1.0)
+        return INFINITY;
+    return -400.0 * std::log10(1.0 / score - 1.0);
+}
+
+// Mean score per game and the variance of one game's score
+void score_moments(const Record &r, double &mean, double &variance)
+{
+    double n = r.games();
+    mean = (r.wins + 0.5 * r.draws) / n;
+    variance = (r.wins * (1.0 - mean) * (1.0 - mean) + r.draws * (0.5 - mean) * (0.5 - mean) + r.losses * mean * mean) / n;
+}
+
+// When every game so far ended the same way the variance is 0; one virtual
+// draw stands in for the spread the next games will show
+double score_spread(Record r)
+{
+    double mean, variance;
+    score_moments(r, mean, variance);
+    if (variance <= 0.0)
+    {
+        ++r.draws;
+        score_moments(r, mean, variance);
+    }
+    return variance;
+}
+
+// Elo difference and its 95% interval, from the normal approximation of the mean score
+void estimate_elo(const Record &r, double &elo, double &low, double &high)
+{
+    double mean, variance;
+    score_moments(r, mean, variance);
+    double margin = Z_95 * std::sqrt(score_spread(r) / r.games());
+    elo = elo_from_score(mean);
+    low = elo_from_score(mean - margin);
+    high = elo_from_score(mean + margin);
+}
+
+// Log-likelihood ratio of "Elo = elo1" over "Elo = elo0": the generalized
+// SPRT on the mean score, as chess engine testing runs it
+double sprt_llr(const Record &r, double elo0, double elo1)
+{
+    if (r.games() == 0)
+        return 0.0;
+    double mean, variance;
+    score_moments(r, mean, variance);
+    variance = score_spread(r);
+    double s0 = score_from_elo(elo0), s1 = score_from_elo(elo1);
+    return (s1 - s0) * (2.0 * mean - s0 - s1) * r.games() / (2.0 * variance);
+}
+
+std::string format_elo(const Record &r)
+{
+    if (r.games() == 0)
+        return "-";
+    double elo, low, high;
+    estimate_elo(r, elo, low, high);
+    char text[64];
+    std::snprintf(text, sizeof(text), "%+.0f [%+.0f, %+.0f]", elo, low, high);
+    return text;
+}
+
+// --- Setup ---
+
+std::string map_path(const TournamentOptions &options, const std::string &name)
+{
+    if (name.find('/') != std::string::npos)
+        return name;
+    std::string file = name.find('.') == std::string::npos ? name + ".txt" : name;
+    return options.map_dir + "/" + file;
+}
+
+std::vector<std::string> list_maps(const std::string &map_dir)
+{
+    std::vector<std::string> names;
+    if (DIR *dir = opendir(map_dir.c_str()))
+    {
+        while (dirent *entry = readdir(dir))
+        {
+            std::string name = entry->d_name;
+            if (name.size() > 4 && name.compare(name.size() - 4, 4, ".txt") == 0)
+                names.push_back(name);
+        }
+        closedir(dir);
+    }
+    std::sort(names.begin(), names.end());
+    return names;
+}
+
+void print_usage(const char *program)
+{
+    std::cerr << "usage: " << program << " [--gauntlet] [--map=NAME]... [--map-dir=DIR] [--seeds=N] [--seed=N] [--jobs=N]\n"
+              << "       [--sprt=ELO0,ELO1] [--alpha=A] [--beta=B] [--timeout-ms=N] [--temp-dir=DIR] [--keep-dirs]\n"
+              << "       PLAYER PLAYER [PLAYER...]\n"
+              << "PLAYER is [label=][lib:|exe:]path[ options], e.g. \"lib:./libbot.so --engine=alphabeta\"" << std::endl;
+}
+
+bool parse_options(int argc, char *argv[], TournamentOptions &options, std::vector<PlayerSpec> &players)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg == "--gauntlet")
+            options.gauntlet = true;
+        else if (arg.compare(0, 6, "--map=") == 0)
+        {
+            std::istringstream names(arg.substr(6));
+            std::string name;
+            while (std::getline(names, name, ','))
+                options.maps.push_back(name);
+        }
+        else if (arg.compare(0, 10, "--map-dir=") == 0)
+            options.map_dir = arg.substr(10);
+        else if (arg.compare(0, 8, "--seeds=") == 0)
+            options.seeds = std::max(1, std::atoi(arg.c_str() + 8));
+        else if (arg.compare(0, 7, "--seed=") == 0)
+            options.seed = std::strtoull(arg.c_str() + 7, nullptr, 10);
+        else if (arg.compare(0, 7, "--jobs=") == 0)
+            options.jobs = std::max(0, std::atoi(arg.c_str() + 7));
+        else if (arg.compare(0, 7, "--sprt=") == 0)
+        {
+            options.sprt = std::sscanf(arg.c_str() + 7, "%lf,%lf", &options.elo0, &options.elo1) == 2 && options.elo0 < options.elo1;
+            if (!options.sprt)
+            {
+                std::cerr << "Error: --sprt needs ELO0,ELO1 with ELO0 < ELO1" << std::endl;
+                return false;
+            }
+        }
+        else if (arg.compare(0, 8, "--alpha=") == 0)
+            options.alpha = std::atof(arg.c_str() + 8);
+        else if (arg.compare(0, 7, "--beta=") == 0)
+            options.beta = std::atof(arg.c_str() + 7);
+        else if (arg.compare(0, 13, "--timeout-ms=") == 0)
+            options.timeout_ms = std::max(1, std::atoi(arg.c_str() + 13));
+        else if (arg.compare(0, 11, "--temp-dir=") == 0)
+            options.temp_dir = arg.substr(11);
+        else if (arg == "--keep-dirs")
+            options.keep_dirs = true;
+        else if (arg.compare(0, 2, "--") == 0)
+        {
+            std::cerr << "Error: unknown option " << arg << std::endl;
+            return false;
+        }
+        else
+        {
+            PlayerSpec spec;
+            std::string error;
+            if (!parse_player_spec(arg, spec, &error))
+            {
+                std::cerr << "Error: " << error << std::endl;
+                return false;
+            }
+            players.push_back(spec);
+        }
+    }
+    if (options.alpha <= 0.0 || options.alpha >= 1.0 || options.beta <= 0.0 || options.beta >= 1.0)
+    {
+        std::cerr << "Error: --alpha and --beta must be in (0, 1)" << std::endl;
+        return false;
+    }
+    return players.size() >= 2;
+}
+
+int main(int argc, char *argv[])
+{
+    std::ios_base::sync_with_stdio(false);
+    TournamentOptions options;
+    std::vector<PlayerSpec> players;
+    if (!parse_options(argc, argv, options, players))
+    {
+        print_usage(argv[0]);
+        return 1;
+    }
+    if (options.maps.empty())
+        options.maps = list_maps(options.map_dir);
+    if (options.maps.empty())
+    {
+        std::cerr << "Error: no maps in " << options.map_dir << std::endl;
+        return 1;
+    }
+    std::vector<MatchMap> maps(options.maps.size());
+    for (size_t m = 0; m < maps.size(); ++m)
+    {
+        std::string error;
+        if (!load_match_map(map_path(options, options.maps[m]), maps[m], &error))
+        {
+            std::cerr << "Error: " << error << std::endl;
+            return 1;
+        }
+    }
+
+    std::vector<Pairing> pairings;
+    for (int a = 0; a < int(players.size()); ++a)
+    {
+        for (int b = a + 1; b < int(players.size()); ++b)
+        {
+            if (!options.gauntlet || a == 0)
+                pairings.push_back(Pairing{a, b, Record(), 0, false, std::string()});
+        }
+    }
+    // Seed by seed, so a pairing stopped early has still seen every map
+    std::vector<TournamentGame> schedule;
+    for (int s = 0; s < options.seeds; ++s)
+    {
+        for (size_t m = 0; m < maps.size(); ++m)
+        {
+            for (size_t p = 0; p < pairings.size(); ++p)
+            {
+                for (bool swapped : {false, true})
+                    schedule.push_back({int(p), int(m), options.seed + uint64_t(s), swapped});
+            }
+        }
+    }
+
+    if (options.temp_dir.empty())
+        options.temp_dir = std::getenv("TMPDIR") ? std::getenv("TMPDIR") : "/tmp";
+    std::string root_template = options.temp_dir + "/tournament-XXXXXX";
+    if (!mkdtemp(&root_template[0]))
+    {
+        std::cerr << "Error: cannot create a folder in " << options.temp_dir << std::endl;
+        return 1;
+    }
+    const std::string root = root_template;
+
+    ThreadPool pool(options.jobs);
+    std::vector<std::unique_ptr<MatchWorker>> workers;
+    for (int w = 0; w < pool.size(); ++w)
+        workers.emplace_back(new MatchWorker(root + "/worker" + std::to_string(w), options.timeout_ms, options.keep_dirs));
+
+    const double lower_bound = std::log(options.beta / (1.0 - options.alpha));
+    const double upper_bound = std::log((1.0 - options.beta) / options.alpha);
+    std::vector<Record> records(players.size()); // Per player, against everyone
+    std::mutex report_mutex;
+    std::atomic<int> next_game(0);
+    std::atomic<bool> failed(false);
+    int finished = 0, skipped = 0;
+
+    std::cout << players.size() << " players, " << pairings.size() << " pairing(s), " << maps.size() << " map(s), up to "
+              << schedule.size() << " games on " << pool.size() << " thread(s)";
+    if (options.sprt)
+        std::cout << ", SPRT elo0 " << options.elo0 << " elo1 " << options.elo1 << " alpha " << options.alpha << " beta " << options.beta;
+    std::cout << std::endl;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    // One task per thread, each taking games in schedule order
+    pool.run(pool.size(),
+             [&](int, int w)
+             {
+                 for (int task; !failed && (task = next_game++) < int(schedule.size());)
+                 {
+                     const TournamentGame &game = schedule[task];
+                     Pairing &pairing = pairings[game.pairing];
+                     {
+                         std::lock_guard<std::mutex> lock(report_mutex);
+                         if (pairing.decided)
+                         {
+                             ++skipped;
+                             continue;
+                         }
+                     }
+                     std::vector<int> seating = {pairing.first, pairing.second};
+                     if (game.swapped)
+                         std::swap(seating[0], seating[1]);
+                     MatchResult result;
+                     std::string error;
+                     if (!workers[w]->play(maps[game.map], players, seating, game.seed, "game" + std::to_string(task), result, &error))
+                     {
+                         std::lock_guard<std::mutex> lock(report_mutex);
+                         if (!failed.exchange(true))
+                             std::cerr << "Error: " << error << std::endl;
+                         return;
+                     }
+
+                     std::lock_guard<std::mutex> lock(report_mutex);
+                     for (int i = 0; i < 2; ++i)
+                         records[seating[i]].add(match_score(result, i), result.area[i]);
+                     int first_seat = game.swapped ? 1 : 0;
+                     pairing.record.add(match_score(result, first_seat), result.area[first_seat]);
+                     pairing.second_area += result.area[1 - first_seat];
+                     ++finished;
+
+                     const char *outcome[3] = {"0-1", "1/2-1/2", "1-0"};
+                     std::cout << "[" << finished << "] " << maps[game.map].name << " seed " << game.seed << "  A "
+                               << players[seating[0]].label << " " << result.area[0] << " : " << result.area[1] << " B "
+                               << players[seating[1]].label << "  " << outcome[int(match_score(result, 0) * 2.0)] << std::endl;
+
+                     if (options.sprt && !pairing.decided)
+                     {
+                         double llr = sprt_llr(pairing.record, options.elo0, options.elo1);
+                         if (llr <= lower_bound || llr >= upper_bound)
+                         {
+                             pairing.decided = true;
+                             std::ostringstream verdict;
+                             verdict << (llr >= upper_bound ? "H1 (>= " : "H0 (<= ") << (llr >= upper_bound ? options.elo1 : options.elo0)
+                                     << " Elo) accepted, LLR " << llr << " after " << pairing.record.games() << " games";
+                             pairing.verdict = verdict.str();
+                             std::cout << "SPRT " << players[pairing.first].label << " vs " << players[pairing.second].label << ": "
+                                       << pairing.verdict << std::endl;
+                         }
+                     }
+                 }
+             });
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    workers.clear(); // Unloads the plugins before their files go
+    if (!options.keep_dirs)
+        remove_directory_tree(root);
+    else
+        std::cout << "Game folders kept in " << root << std::endl;
+    if (failed)
+        return 1;
+
+    std::cout << "\n" << finished << " game(s) in " << elapsed << " s";
+    if (skipped > 0)
+        std::cout << ", " << skipped << " skipped after SPRT";
+    std::cout << ". The larger final area wins, equal areas draw.\n\n";
+
+    char line[256];
+    std::snprintf(line, sizeof(line), "%-32s %6s %6s %6s %6s %7s %10s  %s", "player", "games", "wins", "draws", "losses", "score",
+                  "mean area", "Elo vs opponents [95%]");
+    std::cout << line << '\n';
+    for (size_t p = 0; p < players.size(); ++p)
+    {
+        const Record &r = records[p];
+        double games = std::max(r.games(), 1);
+        std::snprintf(line, sizeof(line), "%-32s %6d %6d %6d %6d %6.1f%% %10.1f  %s", players[p].label.c_str(), r.games(), r.wins,
+                      r.draws, r.losses, 100.0 * (r.wins + 0.5 * r.draws) / games, r.area / games, format_elo(r).c_str());
+        std::cout << line << '\n';
+    }
+
+    std::cout << '\n';
+    std::snprintf(line, sizeof(line), "%-48s %6s %13s %7s %14s  %s", "pairing", "games", "W-D-L", "score", "mean areas",
+                  "Elo of the first [95%]");
+    std::cout << line << '\n';
+    for (const Pairing &pairing : pairings)
+    {
+        const Record &r = pairing.record;
+        double games = std::max(r.games(), 1);
+        std::string names = players[pairing.first].label + " vs " + players[pairing.second].label;
+        std::string wdl = std::to_string(r.wins) + "-" + std::to_string(r.draws) + "-" + std::to_string(r.losses);
+        char areas[32];
+        std::snprintf(areas, sizeof(areas), "%.1f : %.1f", r.area / games, pairing.second_area / games);
+        std::snprintf(line, sizeof(line), "%-48s %6d %13s %6.1f%% %14s  %s", names.c_str(), r.games(), wdl.c_str(),
+                      100.0 * (r.wins + 0.5 * r.draws) / games, areas, format_elo(r).c_str());
+        std::cout << line << '\n';
+        if (options.sprt)
+        {
+            std::cout << "    SPRT: "
+                      << (pairing.decided ? pairing.verdict : "undecided, LLR " + std::to_string(sprt_llr(r, options.elo0, options.elo1)) +
+                                                                     " within (" + std::to_string(lower_bound) + ", " +
+                                                                     std::to_string(upper_bound) + ")")
+                      << '\n';
+        }
+    }
+    return 0;
+}
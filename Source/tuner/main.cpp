@@ -0,0 +1,452 @@
+#include <dirent.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../common/eval_weights.h"
+#include "../common/match.h"
+#include "../common/thread_pool.h"
+
+// --- Tuner ---
+//
+// Tunes a bot's evaluate_move weights (see eval_weights.h) on in-process
+// games with SPSA, simultaneous perturbation stochastic approximation:
+//   tuner [options] "lib:./libGreedy.so [options]"
+// Iteration k nudges every weight at once, by +c_k or -c_k of its step at
+// random, and plays the "plus" copy of the bot against the "minus" copy over
+// --pairs maps x seeds in both seat orders, in parallel. The weights then
+// move along the nudge in proportion to how much plus outscored minus. c_k
+// and the learning rate a_k shrink as in Spall's recommended schedule. At the
+// end the tuned weights play the starting ones over fresh seeds, and if they
+// score better --write=FILE rewrites the bot's WEIGHTS table with them.
+
+struct TunerOptions
+{
+    std::vector<std::string> maps; // Every map in map_dir when empty
+    std::string map_dir = "Simulator/Map";
+    uint64_t seed = 1;
+    int jobs = 0;
+    int timeout_ms = 2000;
+    std::string temp_dir;
+    int iterations = 200;
+    int pairs = 8;           // Seeds per iteration, each played in both seat orders
+    double step = 0.2;       // c_0, as a fraction of each weight's starting value
+    double rate = 2.0;       // a_0, in steps per unit of gradient
+    std::vector<std::string> tune; // Weights to tune; all when empty
+    int verify = 100;        // Seeds for the final tuned-vs-start check
+    std::string write;       // Source file whose WEIGHTS table gets the result
+};
+
+// SPSA gains (Spall 1998): a_k = a / (k + 1 + A)^ALPHA, c_k = c / (k + 1)^GAMMA
+const double SPSA_ALPHA = 0.602;
+const double SPSA_GAMMA = 0.101;
+
+// A weight vector as bot_weights() reports it
+struct WeightVector
+{
+    std::vector<std::string> names;
+    std::vector<double> values;
+
+    bool parse(const std::string &text)
+    {
+        std::istringstream items(text);
+        std::string item;
+        while (std::getline(items, item, ','))
+        {
+            size_t equals = item.find('=');
+            if (equals == std::string::npos)
+                return false;
+            names.push_back(item.substr(0, equals));
+            values.push_back(std::atof(item.c_str() + equals + 1));
+        }
+        return !names.empty();
+    }
+
+    std::string format() const
+    {
+        std::string text;
+        for (size_t i = 0; i < names.size(); ++i)
+            text += (i ? "," : "") + names[i] + "=" + format_weight(values[i]);
+        return text;
+    }
+};
+
+// The player with its weights replaced by `weights`
+PlayerSpec with_weights(const PlayerSpec &base, const std::string &label, const WeightVector &weights)
+{
+    PlayerSpec spec = base;
+    spec.label = label;
+    spec.options += (spec.options.empty() ? "" : " ") + std::string("--weights=") + weights.format();
+    return spec;
+}
+
+// Four significant digits: the games cannot tell more apart
+double round_weight(double value)
+{
+    char text[32];
+    std::snprintf(text, sizeof(text), "%.4g", value);
+    return std::atof(text);
+}
+
+// As a double literal, the way the WEIGHTS tables spell them
+std::string weight_literal(double value)
+{
+    std::string text = format_weight(value);
+    if (text.find_first_of(".e") == std::string::npos)
+        text += ".0";
+    return text;
+}
+
+// Replaces the number in every `{"name", number}` entry of the WEIGHTS table
+// in `source`
+bool rewrite_weights_table(const std::string &source, const WeightVector &weights, std::string *error)
+{
+    std::string text;
+    if (!read_whole_file(source, text))
+        return map_parse_fail(error, "cannot read " + source);
+    for (size_t i = 0; i < weights.names.size(); ++i)
+    {
+        std::string key = "{\"" + weights.names[i] + "\", ";
+        size_t at = text.find(key);
+        if (at == std::string::npos || text.find(key, at + 1) != std::string::npos)
+            return map_parse_fail(error, source + " does not have exactly one entry " + key + "...}");
+        size_t number = at + key.size();
+        size_t end = text.find('}', number);
+        if (end == std::string::npos)
+            return map_parse_fail(error, "unterminated entry " + key + "... in " + source);
+        text.replace(number, end - number, weight_literal(weights.values[i]));
+    }
+    if (!write_file(source, text))
+        return map_parse_fail(error, "cannot write " + source);
+    return true;
+}
+
+std::string map_path(const TunerOptions &options, const std::string &name)
+{
+    if (name.find('/') != std::string::npos)
+        return name;
+    std::string file = name.find('.') == std::string::npos ? name + ".txt" : name;
+    return options.map_dir + "/" + file;
+}
+
+std::vector<std::string> list_maps(const std::string &map_dir)
+{
+    std::vector<std::string> names;
+    if (DIR *dir = opendir(map_dir.c_str()))
+    {
+        while (dirent *entry = readdir(dir))
+        {
+            std::string name = entry->d_name;
+            if (name.size() > 4 && name.compare(name.size() - 4, 4, ".txt") == 0)
+                names.push_back(name);
+        }
+        closedir(dir);
+    }
+    std::sort(names.begin(), names.end());
+    return names;
+}
+
+// Infinite for a score of 0 or 1
+double elo_from_score(double score)
+{
+    if (score <= 0.0)
+        return -INFINITY;
+    if (score >= 1.0)
+        return INFINITY;
+    return -400.0 * std::log10(1.0 / score - 1.0);
+}
+
+void print_usage(const char *program)
+{
+    std::cerr << "usage: " << program << " [--map=NAME]... [--map-dir=DIR] [--seed=N] [--jobs=N] [--temp-dir=DIR]\n"
+              << "       [--iterations=N] [--pairs=N] [--step=F] [--rate=R] [--tune=NAME,...] [--verify=N] [--write=FILE]\n"
+              << "       PLAYER\n"
+              << "PLAYER is lib:path[ options] for a bot built with -DBOT_LIBRARY, e.g. \"lib:./libGreedy.so\"" << std::endl;
+}
+
+bool parse_options(int argc, char *argv[], TunerOptions &options, std::vector<PlayerSpec> &players)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg.compare(0, 6, "--map=") == 0 || arg.compare(0, 7, "--tune=") == 0)
+        {
+            std::vector<std::string> &list = arg[2] == 'm' ? options.maps : options.tune;
+            std::istringstream names(arg.substr(arg.find('=') + 1));
+            std::string name;
+            while (std::getline(names, name, ','))
+                list.push_back(name);
+        }
+        else if (arg.compare(0, 10, "--map-dir=") == 0)
+            options.map_dir = arg.substr(10);
+        else if (arg.compare(0, 7, "--seed=") == 0)
+            options.seed = std::strtoull(arg.c_str() + 7, nullptr, 10);
+        else if (arg.compare(0, 7, "--jobs=") == 0)
+            options.jobs = std::max(0, std::atoi(arg.c_str() + 7));
+        else if (arg.compare(0, 11, "--temp-dir=") == 0)
+            options.temp_dir = arg.substr(11);
+        else if (arg.compare(0, 13, "--iterations=") == 0)
+            options.iterations = std::max(1, std::atoi(arg.c_str() + 13));
+        else if (arg.compare(0, 8, "--pairs=") == 0)
+            options.pairs = std::max(1, std::atoi(arg.c_str() + 8));
+        else if (arg.compare(0, 7, "--step=") == 0)
+            options.step = std::atof(arg.c_str() + 7);
+        else if (arg.compare(0, 7, "--rate=") == 0)
+            options.rate = std::atof(arg.c_str() + 7);
+        else if (arg.compare(0, 9, "--verify=") == 0)
+            options.verify = std::max(0, std::atoi(arg.c_str() + 9));
+        else if (arg.compare(0, 8, "--write=") == 0)
+            options.write = arg.substr(8);
+        else if (arg.compare(0, 2, "--") == 0)
+        {
+            std::cerr << "Error: unknown option " << arg << std::endl;
+            return false;
+        }
+        else
+        {
+            PlayerSpec spec;
+            std::string error;
+            if (!parse_player_spec(arg, spec, &error))
+            {
+                std::cerr << "Error: " << error << std::endl;
+                return false;
+            }
+            players.push_back(spec);
+        }
+    }
+    if (options.step <= 0.0 || options.rate <= 0.0)
+    {
+        std::cerr << "Error: --step and --rate must be positive" << std::endl;
+        return false;
+    }
+    return players.size() == 1;
+}
+
+int main(int argc, char *argv[])
+{
+    std::ios_base::sync_with_stdio(false);
+    TunerOptions options;
+    std::vector<PlayerSpec> players;
+    if (!parse_options(argc, argv, options, players))
+    {
+        print_usage(argv[0]);
+        return 1;
+    }
+    const PlayerSpec base = players[0];
+    if (base.kind != PLAYER_LIBRARY)
+    {
+        std::cerr << "Error: the tuner plays bots in-process; build " << base.path << " with -DBOT_LIBRARY and pass lib:" << std::endl;
+        return 1;
+    }
+    if (options.maps.empty())
+        options.maps = list_maps(options.map_dir);
+    if (options.maps.empty())
+    {
+        std::cerr << "Error: no maps in " << options.map_dir << std::endl;
+        return 1;
+    }
+    std::vector<MatchMap> maps(options.maps.size());
+    for (size_t m = 0; m < maps.size(); ++m)
+    {
+        std::string error;
+        if (!load_match_map(map_path(options, options.maps[m]), maps[m], &error))
+        {
+            std::cerr << "Error: " << error << std::endl;
+            return 1;
+        }
+    }
+
+    if (options.temp_dir.empty())
+        options.temp_dir = std::getenv("TMPDIR") ? std::getenv("TMPDIR") : "/tmp";
+    std::string root_template = options.temp_dir + "/tuner-XXXXXX";
+    if (!mkdtemp(&root_template[0]))
+    {
+        std::cerr << "Error: cannot create a folder in " << options.temp_dir << std::endl;
+        return 1;
+    }
+    const std::string root = root_template;
+
+    // The starting point: the bot's weights under the options it was given
+    WeightVector start;
+    {
+        BotLibrary library;
+        std::string error;
+        if (!library.load(base.path, root + "/start.so", &error))
+        {
+            std::cerr << "Error: " << error << std::endl;
+            remove_directory_tree(root);
+            return 1;
+        }
+        BotInstance *bot = library.weights ? library.create(base.options.c_str()) : nullptr;
+        bool parsed = bot && start.parse(library.weights(bot));
+        if (bot)
+            library.destroy(bot);
+        if (!parsed)
+        {
+            std::cerr << "Error: " << base.path << " has no tunable weights (bot_weights)" << std::endl;
+            remove_directory_tree(root);
+            return 1;
+        }
+    }
+    // Tuned weights and their step sizes; a weight starting at 0 steps by --step
+    std::vector<int> tuned;
+    std::vector<double> steps;
+    for (size_t i = 0; i < start.names.size(); ++i)
+    {
+        if (options.tune.empty() || std::find(options.tune.begin(), options.tune.end(), start.names[i]) != options.tune.end())
+        {
+            tuned.push_back(int(i));
+            steps.push_back(options.step * (start.values[i] != 0.0 ? std::fabs(start.values[i]) : 1.0));
+        }
+    }
+    for (const std::string &name : options.tune)
+    {
+        if (std::find(start.names.begin(), start.names.end(), name) == start.names.end())
+        {
+            std::cerr << "Error: " << base.label << " has no weight '" << name << "'" << std::endl;
+            remove_directory_tree(root);
+            return 1;
+        }
+    }
+
+    ThreadPool pool(options.jobs);
+    std::vector<std::unique_ptr<MatchWorker>> workers;
+    for (int w = 0; w < pool.size(); ++w)
+        workers.emplace_back(new MatchWorker(root + "/worker" + std::to_string(w), options.timeout_ms, false));
+    uint64_t next_seed = options.seed;
+    int next_map = 0;
+
+    // Plays players[0] against players[1] over `pairs` seeds in both seat
+    // orders; adds players[0]'s wins, draws and losses to `record`
+    auto play_batch = [&](const std::vector<PlayerSpec> &batch_players, int pairs, int record[3]) -> bool
+    {
+        std::vector<uint64_t> seeds;
+        std::vector<int> batch_maps;
+        for (int j = 0; j < pairs; ++j)
+        {
+            seeds.push_back(next_seed++);
+            batch_maps.push_back(next_map++ % int(maps.size()));
+        }
+        std::vector<double> scores(2 * pairs);
+        std::mutex error_mutex;
+        bool failed = false;
+        pool.run(2 * pairs,
+                 [&](int task, int w)
+                 {
+                     int j = task / 2;
+                     bool swapped = task % 2 == 1;
+                     std::vector<int> seating = swapped ? std::vector<int>{1, 0} : std::vector<int>{0, 1};
+                     MatchResult result;
+                     std::string error;
+                     if (!workers[w]->play(maps[batch_maps[j]], batch_players, seating, seeds[j], "game" + std::to_string(task), result, &error))
+                     {
+                         std::lock_guard<std::mutex> lock(error_mutex);
+                         if (!failed)
+                             std::cerr << "Error: " << error << std::endl;
+                         failed = true;
+                         return;
+                     }
+                     scores[task] = match_score(result, swapped ? 1 : 0);
+                 });
+        for (double score : scores)
+            ++record[int(score * 2.0)]; // losses, draws, wins
+        return !failed;
+    };
+
+    std::cout << "Tuning " << tuned.size() << " of " << start.names.size() << " weights of " << base.label << " over "
+              << maps.size() << " map(s), " << options.iterations << " iterations of " << 2 * options.pairs << " games on "
+              << pool.size() << " thread(s)\nstart: " << start.format() << std::endl;
+
+    // SPSA over x = weight / step, so every weight moves on the same scale
+    const double big_a = 0.1 * options.iterations;
+    const double a = options.rate * std::pow(1.0 + big_a, SPSA_ALPHA);
+    WeightVector current = start;
+    std::mt19937_64 rng(options.seed);
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    for (int k = 0; k < options.iterations; ++k)
+    {
+        double a_k = a / std::pow(k + 1 + big_a, SPSA_ALPHA);
+        double c_k = 1.0 / std::pow(k + 1, SPSA_GAMMA);
+        std::vector<int> delta(tuned.size());
+        WeightVector plus = current, minus = current;
+        for (size_t t = 0; t < tuned.size(); ++t)
+        {
+            delta[t] = rng() & 1 ? 1 : -1;
+            int i = tuned[t];
+            plus.values[i] = std::max(0.0, current.values[i] + c_k * delta[t] * steps[t]);
+            minus.values[i] = std::max(0.0, current.values[i] - c_k * delta[t] * steps[t]);
+        }
+        int record[3] = {0, 0, 0};
+        if (!play_batch({with_weights(base, "plus", plus), with_weights(base, "minus", minus)}, options.pairs, record))
+        {
+            workers.clear();
+            remove_directory_tree(root);
+            return 1;
+        }
+        // Mean score of plus minus that of minus, in [-1, 1]
+        double difference = double(record[2] - record[0]) / (2 * options.pairs);
+        for (size_t t = 0; t < tuned.size(); ++t)
+        {
+            int i = tuned[t];
+            double gradient = difference / (2.0 * c_k * delta[t]);
+            current.values[i] = std::max(0.0, current.values[i] + a_k * gradient * steps[t]);
+        }
+
+        std::cout << "iteration " << k + 1 << ": plus " << record[2] << "-" << record[1] << "-" << record[0] << " minus, a "
+                  << a_k << " c " << c_k << std::endl;
+        if ((k + 1) % 10 == 0)
+            std::cout << "weights: " << current.format() << std::endl;
+    }
+    for (int i : tuned)
+        current.values[i] = round_weight(current.values[i]);
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    std::cout << "\n" << options.iterations * 2 * options.pairs << " games in " << elapsed << " s\ntuned: " << current.format()
+              << std::endl;
+
+    // Fresh seeds decide whether the tuned weights are kept
+    bool better = false;
+    if (options.verify > 0)
+    {
+        int record[3] = {0, 0, 0};
+        if (!play_batch({with_weights(base, "tuned", current), with_weights(base, "start", start)}, options.verify, record))
+        {
+            workers.clear();
+            remove_directory_tree(root);
+            return 1;
+        }
+        int games = 2 * options.verify;
+        double score = (record[2] + 0.5 * record[1]) / games;
+        char line[160];
+        std::snprintf(line, sizeof(line), "tuned vs start: %d-%d-%d over %d games, score %.3f, %+.0f Elo", record[2], record[1],
+                      record[0], games, score, elo_from_score(score));
+        std::cout << line << std::endl;
+        better = score > 0.5;
+    }
+    workers.clear(); // Unloads the plugins before their files go
+    remove_directory_tree(root);
+
+    if (!options.write.empty())
+    {
+        std::string error;
+        if (!better)
+            std::cout << options.write << " left as it is: the tuned weights did not beat the starting ones" << std::endl;
+        else if (!rewrite_weights_table(options.write, current, &error))
+        {
+            std::cerr << "Error: " << error << std::endl;
+            return 1;
+        }
+        else
+            std::cout << "Wrote the tuned weights to " << options.write << "; rebuild the bot to compile them in" << std::endl;
+    }
+    return 0;
+}